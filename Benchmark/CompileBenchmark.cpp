@@ -0,0 +1,72 @@
+//
+//  CompileBenchmark.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+// Measures compile time of `NFA(const string&)` against pattern length, with the NFA built eagerly (simplified after every composition, as before)
+// and with Thompson's construction from the parsed pattern, simplified once at last.
+
+#include <chrono>
+#include <iostream>
+
+#include "NFA.hpp"
+#include "DFA.hpp"
+
+using namespace FAS;
+
+// The old loop of `NFA(const string&)` for patterns of letters, `.` and `*`, without building mode, so every `makeConcatenation` determinizes and minimizes the whole NFA.
+static NFA compileEagerly(const string& pattern)
+{
+    NFA result;
+    NFA n;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] == '*') { continue; }
+        n = NFA((FASymbol)pattern[i]);
+        if (i + 1 < pattern.size() && pattern[i + 1] == '*') {
+            n.makeStar();
+        }
+        result.makeConcatenation(n);
+    }
+    return result;
+}
+
+template <typename Function>
+static double measure(Function f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main()
+{
+    const string piece = "ab*c.d*";
+
+    std::cout << "length\teager_ms\tbuilding_ms\tspeedup\tresult" << std::endl;
+
+    for (size_t count = 1; count <= 64; count *= 2) {
+
+        string pattern;
+        for (size_t i = 0; i < count; i++) {
+            pattern += piece;
+        }
+
+        NFA eager;
+        NFA building;
+        double eagerTime = measure([&]() { eager = compileEagerly(pattern); });
+        double buildingTime = measure([&]() { building = NFA(pattern); });
+
+        // Both are minimal DFAs in the end, so they must agree on any input.
+        string sample;
+        for (size_t i = 0; i < count; i++) {
+            sample += "abbcxd";
+        }
+        bool same = DFA(eager).recognize(sample) == DFA(building).recognize(sample) && eager.recognize(sample + "a") == building.recognize(sample + "a");
+
+        std::cout << pattern.size() << "\t" << eagerTime << "\t" << buildingTime << "\t" << eagerTime / buildingTime << "\t" << (same ? "same" : "DIFFERENT") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,559 @@
+//
+//  RegexBenchmark.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+// Measures compiling and matching of literal, class-heavy, alternation-heavy and pathological patterns over generated log, DNA and English-like text corpora, for tracking regressions over time.
+// Every case runs in a child process, so its peak memory is its own, and a crash or a blow-up only loses that case.
+//
+//     RegexBenchmark [--size bytes] [--repeat count] [--tsv] [--output path] [name-filter]
+//
+// Output is one JSON object per line: a "run" record describing the run, then a "case" record for every case, or an "error" record if its process failed. Times are the best of `--repeat` runs. With `--tsv`, cases are a table for reading instead.
+//
+//     nfa_ms             `NFA(const string&)`
+//     dfa_ms             `DFA(const NFA&&)`, which is determinize_ms and simplify_ms
+//     determinize_ms     subset construction alone
+//     simplify_ms        `DFA::simplify` of the subset construction
+//     dense_ms           `DenseDFA(const DFA&)`
+//     dfa_states         states of the simplified DFA
+//     dense_bytes        `DenseDFA::memoryUsage`
+//     recognize_mbps     `DenseDFA::recognize` of every line of the corpus, in MB of lines per second
+//     find_mbps          `DenseDFA::findRecognizedSubstrings` of the whole corpus
+//     dfa_find_mbps      `DFA::findRecognizedSubstrings` of the whole corpus
+//     recognized_lines   count of lines matching the whole pattern
+//     matches            count of substrings found in the corpus
+//     engines_agree      whether `DFA`, `DenseDFA` and `ParallelMatcher` found the same count
+//     peak_rss_kb        growth of the peak resident set while compiling and matching, in KB
+//
+// Core scaling of `ParallelMatcher` on the whole corpus is measured at the thread counts of `ScalingThreads`, the same on every machine, so columns line up across runs. The run record has `hardware_threads` to tell which counts had cores of their own.
+//
+//     parallel_find_mbps_tN        `ParallelMatcher::findRecognizedSubstrings` with N threads
+//     parallel_recognize_mbps_tN   `ParallelMatcher::recognize` of the whole corpus with N threads, by the automaton of `(.|\n)*(pattern)`, which never dies, so every byte is scanned
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "NFA.hpp"
+#include "DFA.hpp"
+#include "DenseDFA.hpp"
+#include "ParallelMatcher.hpp"
+
+using namespace FAS;
+
+static const unsigned int FormatVersion = 2;
+static const unsigned int ScalingThreads[] = {1, 2, 4, 8};
+
+class BenchmarkDFA: public DFA
+{
+public:
+
+    void determinize(const NFA& n) { DFA::determinize(n); }
+    void simplify(void) { DFA::simplify(); }
+    FAState stateCount(void) const { return states; }
+};
+
+struct Case
+{
+    const char *name;
+    const char *category; // literal, class, alternation or pathological
+    const char *corpus;
+    const char *pattern;
+};
+
+static const Case Cases[] = {
+    {"log/literal", "literal", "log", "ERROR"},
+    {"log/phrase", "literal", "log", "connection reset by peer"},
+    {"log/ipv4", "class", "log", "[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}"},
+    {"log/timestamp", "class", "log", "\\d{4}-\\d{2}-\\d{2}T\\d{2}:\\d{2}:\\d{2}\\.\\d{3}Z"},
+    {"log/methods", "alternation", "log", "GET|POST|PUT|DELETE|PATCH|HEAD|OPTIONS"},
+    {"log/levels", "alternation", "log", "(ERROR|WARN|FATAL|CRITICAL|ALERT|EMERGENCY) \\[[a-z]+-[0-9]+\\]"},
+    {"log/dot-star", "pathological", "log", ".*user=[a-z]+.*[0-9]+ms"},
+    {"dna/literal", "literal", "dna", "GATTACA"},
+    {"dna/tata-box", "class", "dna", "[ACGT]{4}TATA[AT]A[AT][ACGT]{2}"},
+    {"dna/restriction-sites", "alternation", "dna", "GAATTC|GGATCC|AAGCTT|CTGCAG|GTCGAC|CCCGGG|GCGGCCGC|TCTAGA"},
+    {"dna/suffix-a12", "pathological", "dna", "[ACGT]*A[ACGT]{12}"},
+    {"text/literal", "literal", "text", "the"},
+    {"text/words", "class", "text", "[A-Z][a-z]+ [a-z]+ing"},
+    {"text/identifiers", "class", "text", "\\w+"},
+    {"text/nouns", "alternation", "text", "(time|person|year|way|day|thing|man|world|life|hand|part|child|eye|woman|place|work|week|case|point|number)s?"},
+    {"text/suffix-a12", "pathological", "text", "(a|b)*a(a|b){12}"},
+    {"text/nested-plus", "pathological", "text", "(x+x+)+y"},
+};
+
+// Lines like those of a web service, mostly INFO, with an address, a request and its duration.
+static string generateLog(const size_t size, std::mt19937& random)
+{
+    const char *levels[] = {"INFO", "INFO", "INFO", "INFO", "INFO", "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR", "FATAL"};
+    const char *methods[] = {"GET", "GET", "GET", "POST", "PUT", "DELETE", "PATCH", "HEAD", "OPTIONS"};
+    const char *paths[] = {"/api/v1/users", "/api/v1/orders", "/static/app.js", "/login", "/api/v2/search", "/health"};
+    const char *users[] = {"alice", "bob", "carol", "dave", "eve", "mallory"};
+    const char *messages[] = {"ok", "ok", "ok", "slow response", "connection reset by peer", "timeout waiting for upstream"};
+
+    string corpus;
+    corpus.reserve(size + 256);
+    char line[256];
+    unsigned int seconds = 0;
+    while (corpus.size() < size) {
+        seconds += random() % 3;
+        const char *level = levels[random() % 12];
+        int length = std::snprintf(line, sizeof(line), "2026-10-%02uT%02u:%02u:%02u.%03uZ %s [worker-%u] %u.%u.%u.%u %s %s/%u %u %ums user=%s %s\n",
+                                   1 + seconds / 86400 % 28, seconds / 3600 % 24, seconds / 60 % 60, seconds % 60, (unsigned int)(random() % 1000),
+                                   level, (unsigned int)(random() % 16), 10 + (unsigned int)(random() % 200), (unsigned int)(random() % 256), (unsigned int)(random() % 256), (unsigned int)(random() % 256),
+                                   methods[random() % 9], paths[random() % 6], (unsigned int)(random() % 100000), random() % 10 == 0 ? 500 : 200, (unsigned int)(random() % 2000),
+                                   users[random() % 6], strcmp(level, "ERROR") == 0 ? messages[4] : messages[random() % 6]);
+        corpus.append(line, length);
+    }
+    corpus.resize(size);
+    return corpus;
+}
+
+// FASTA records of 60 bases a line, with a few unknown bases.
+static string generateDNA(const size_t size, std::mt19937& random)
+{
+    string corpus;
+    corpus.reserve(size + 128);
+    unsigned int record = 0;
+    while (corpus.size() < size) {
+        corpus += ">chr" + std::to_string(record % 22 + 1) + " sequence " + std::to_string(record) + "\n";
+        record++;
+        for (unsigned int line = 0; line < 1000 && corpus.size() < size; line++) {
+            for (unsigned int i = 0; i < 60; i++) {
+                corpus += random() % 1000 == 0 ? 'N' : "ACGT"[random() % 4];
+            }
+            corpus += '\n';
+        }
+    }
+    corpus.resize(size);
+    return corpus;
+}
+
+// Sentences of common English words, where the first words of the list are the most frequent, broken into lines of about 72 bytes.
+static string generateText(const size_t size, std::mt19937& random)
+{
+    const char *words[] = {
+        "the", "of", "and", "to", "a", "in", "is", "it", "you", "that", "he", "was", "for", "on", "are", "with", "as", "his", "they", "be",
+        "at", "one", "have", "this", "from", "or", "had", "by", "word", "but", "what", "some", "we", "can", "out", "other", "were", "all", "there", "when",
+        "time", "person", "year", "way", "day", "thing", "man", "world", "life", "hand", "part", "child", "eye", "woman", "place", "work", "week", "case", "point", "number",
+        "going", "being", "nothing", "morning", "evening", "building", "reading", "writing", "thinking", "looking",
+        "about", "because", "between", "through", "during", "without", "against", "among", "around", "behind",
+        "abba", "baba", "banana", "bazaar", "xxy", "axe", "box", "taxi", "exact", "oxygen",
+    };
+    const size_t wordCount = sizeof(words) / sizeof(words[0]);
+    std::geometric_distribution<size_t> rank(0.05);
+
+    string corpus;
+    corpus.reserve(size + 64);
+    size_t lineLength = 0;
+    bool sentenceBegins = true;
+    while (corpus.size() < size) {
+        string word = words[rank(random) % wordCount];
+        if (sentenceBegins) {
+            word[0] = (char)toupper(word[0]);
+        }
+        sentenceBegins = random() % 12 == 0;
+        word += sentenceBegins ? ". " : " ";
+        corpus += word;
+        lineLength += word.size();
+        if (lineLength > 72) {
+            corpus.back() = '\n';
+            lineLength = 0;
+        }
+    }
+    corpus.resize(size);
+    return corpus;
+}
+
+template <typename Function>
+static double measure(const unsigned int repeat, Function f)
+{
+    double best = 0;
+    for (unsigned int i = 0; i < repeat; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        best = i == 0 ? time : std::min(best, time);
+    }
+    return best;
+}
+
+// The best time of `make()`, which constructs the result. The previous result is destroyed out of the timing.
+template <typename T, typename Make>
+static double measureConstruction(const unsigned int repeat, T& result, Make make)
+{
+    double best = 0;
+    for (unsigned int i = 0; i < repeat; i++) {
+        result = T();
+        auto begin = std::chrono::steady_clock::now();
+        result = make();
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        best = i == 0 ? time : std::min(best, time);
+    }
+    return best;
+}
+
+static long peakResidentKB(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+static string jsonString(const string& s)
+{
+    string result = "\"";
+    for (const unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += (char)c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+        } else {
+            result += (char)c;
+        }
+    }
+    return result + "\"";
+}
+
+// The string written by `jsonString`, or `json` itself if it is not a string.
+static string jsonValue(const string& json)
+{
+    if (json.empty() || json.front() != '"') { return json; }
+    string result;
+    for (size_t i = 1; i + 1 < json.size(); i++) {
+        if (json[i] != '\\') {
+            result += json[i];
+        } else if (json[i + 1] == 'u') {
+            result += (char)std::stoi(json.substr(i + 2, 4), nullptr, 16);
+            i += 5;
+        } else {
+            result += json[++i];
+        }
+    }
+    return result;
+}
+
+// Fields of a record in order, with values already written as JSON.
+typedef vector<pair<string, string>> Record;
+
+class Output
+{
+private:
+
+    std::ostream& out;
+    bool tsv;
+    bool headerWritten = false;
+
+public:
+
+    Output(std::ostream& out, const bool tsv): out(out), tsv(tsv) {}
+
+    void write(const Record& record)
+    {
+        if (!tsv) {
+            out << "{";
+            for (size_t i = 0; i < record.size(); i++) {
+                out << (i > 0 ? ", " : "") << jsonString(record[i].first) << ": " << record[i].second;
+            }
+            out << "}" << std::endl;
+            return;
+        }
+
+        // Cases are written as a table, with columns named by the first of them, and other records as comments.
+        if (record[0].second != "\"case\"") {
+            out << "#";
+            for (const auto& [key, value] : record) {
+                out << " " << key << "=" << value;
+            }
+            out << std::endl;
+            return;
+        }
+        if (!headerWritten) {
+            for (size_t i = 1; i < record.size(); i++) {
+                out << (i > 1 ? "\t" : "") << record[i].first;
+            }
+            out << std::endl;
+            headerWritten = true;
+        }
+        for (size_t i = 1; i < record.size(); i++) {
+            out << (i > 1 ? "\t" : "") << jsonValue(record[i].second);
+        }
+        out << std::endl;
+    }
+};
+
+static string number(const double value)
+{
+    std::ostringstream out;
+    out.precision(6);
+    out << value;
+    return out.str();
+}
+
+static Record runCase(const Case& c, const string& corpus, const vector<std::string_view>& lines, const unsigned int repeat)
+{
+    const long residentBefore = peakResidentKB();
+    const string pattern = c.pattern;
+
+    NFA nfa;
+    const double nfaTime = measureConstruction(repeat, nfa, [&]() { return NFA(pattern); });
+
+    DFA dfa;
+    const double dfaTime = measureConstruction(repeat, dfa, [&]() { return DFA(nfa); });
+
+    // The same construction in two steps, timed apart.
+    double determinizeTime = 0;
+    double simplifyTime = 0;
+    FAState dfaStates = 0;
+    for (unsigned int i = 0; i < repeat; i++) {
+        BenchmarkDFA d;
+        const double determinize = measure(1, [&]() { d.determinize(nfa); });
+        const double simplify = measure(1, [&]() { d.simplify(); });
+        determinizeTime = i == 0 ? determinize : std::min(determinizeTime, determinize);
+        simplifyTime = i == 0 ? simplify : std::min(simplifyTime, simplify);
+        dfaStates = d.stateCount();
+    }
+
+    DenseDFA dense;
+    const double denseTime = measureConstruction(repeat, dense, [&]() { return DenseDFA(dfa); });
+
+    size_t recognized = 0;
+    size_t lineBytes = 0;
+    const double recognizeTime = measure(repeat, [&]() {
+        recognized = 0;
+        lineBytes = 0;
+        for (const std::string_view line : lines) {
+            recognized += dense.recognize(line);
+            lineBytes += line.size();
+        }
+    });
+
+    size_t matches = 0;
+    const double findTime = measure(repeat, [&]() { matches = dense.findRecognizedSubstrings(std::string_view(corpus)).size(); });
+
+    size_t dfaMatches = 0;
+    const double dfaFindTime = measure(repeat, [&]() { dfaMatches = dfa.findRecognizedSubstrings(corpus).size(); });
+
+    auto throughput = [](const size_t bytes, const double milliseconds) {
+        return number(milliseconds > 0 ? bytes / 1e6 / (milliseconds / 1e3) : 0);
+    };
+
+    // Chunks are at least 1MB, so a corpus smaller than a few MB is scanned by fewer threads than asked for.
+    const DenseDFA unanchored{DFA{NFA{"(.|\\n)*(" + pattern + ")"}}};
+    const bool endsWithMatch = unanchored.recognize(std::string_view(corpus));
+    Record scaling;
+    bool parallelAgrees = true;
+    for (const unsigned int threads : ScalingThreads) {
+        ParallelMatcher parallel(dense, threads);
+        size_t parallelMatches = 0;
+        const double parallelFindTime = measure(repeat, [&]() { parallelMatches = parallel.findRecognizedSubstrings(std::string_view(corpus)).size(); });
+        ParallelMatcher parallelUnanchored(unanchored, threads);
+        bool recognizedCorpus = false;
+        const double parallelRecognizeTime = measure(repeat, [&]() { recognizedCorpus = parallelUnanchored.recognize(std::string_view(corpus)); });
+        parallelAgrees = parallelAgrees && parallelMatches == matches && recognizedCorpus == endsWithMatch;
+        scaling.push_back({"parallel_find_mbps_t" + std::to_string(threads), throughput(corpus.size(), parallelFindTime)});
+        scaling.push_back({"parallel_recognize_mbps_t" + std::to_string(threads), throughput(corpus.size(), parallelRecognizeTime)});
+    }
+
+    Record record = {
+        {"type", "\"case\""},
+        {"name", jsonString(c.name)},
+        {"category", jsonString(c.category)},
+        {"corpus", jsonString(c.corpus)},
+        {"pattern", jsonString(c.pattern)},
+        {"corpus_bytes", std::to_string(corpus.size())},
+        {"nfa_ms", number(nfaTime)},
+        {"dfa_ms", number(dfaTime)},
+        {"determinize_ms", number(determinizeTime)},
+        {"simplify_ms", number(simplifyTime)},
+        {"dense_ms", number(denseTime)},
+        {"dfa_states", std::to_string(dfaStates)},
+        {"dense_bytes", std::to_string(dense.memoryUsage())},
+        {"recognize_mbps", throughput(lineBytes, recognizeTime)},
+        {"find_mbps", throughput(corpus.size(), findTime)},
+        {"dfa_find_mbps", throughput(corpus.size(), dfaFindTime)},
+        {"recognized_lines", std::to_string(recognized)},
+        {"matches", std::to_string(matches)},
+        {"engines_agree", matches == dfaMatches && parallelAgrees ? "true" : "false"},
+    };
+    record.insert(record.end(), scaling.begin(), scaling.end());
+    record.push_back({"peak_rss_kb", std::to_string(std::max(0L, peakResidentKB() - residentBefore))});
+    return record;
+}
+
+// Run `c` in a child process, which writes its record through a pipe. Returns an error record if the child fails.
+static Record runCaseInChild(const Case& c, const string& corpus, const vector<std::string_view>& lines, const unsigned int repeat)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return runCase(c, corpus, lines, repeat);
+    }
+    std::fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return runCase(c, corpus, lines, repeat);
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        // A trivial case first, so pages of code and heap that every case touches are resident before measuring, and the growth is of `c` alone.
+        const Case warmUp = {"warm-up", "literal", c.corpus, "a"};
+        runCase(warmUp, corpus.substr(0, 4096), vector<std::string_view>(lines.begin(), lines.begin() + std::min<size_t>(lines.size(), 16)), 1);
+
+        string encoded;
+        for (const auto& [key, value] : runCase(c, corpus, lines, repeat)) {
+            encoded += key + '\t' + value + '\n';
+        }
+        for (size_t written = 0; written < encoded.size(); ) {
+            const ssize_t n = write(fds[1], encoded.data() + written, encoded.size() - written);
+            if (n <= 0) { _exit(1); }
+            written += n;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    string encoded;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        encoded.append(buffer, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        const string reason = WIFSIGNALED(status) ? string("signal ") + std::to_string(WTERMSIG(status)) : "exit status " + std::to_string(WEXITSTATUS(status));
+        return {{"type", "\"error\""}, {"name", jsonString(c.name)}, {"pattern", jsonString(c.pattern)}, {"reason", jsonString(reason)}};
+    }
+    Record record;
+    std::istringstream in(encoded);
+    string line;
+    while (std::getline(in, line)) {
+        const size_t tab = line.find('\t');
+        record.push_back({line.substr(0, tab), line.substr(tab + 1)});
+    }
+    return record;
+}
+
+static void usage(void)
+{
+    std::cerr << "usage: RegexBenchmark [--size bytes] [--repeat count] [--tsv] [--output path] [name-filter]" << std::endl;
+}
+
+int main(int argc, const char * argv[])
+{
+    size_t size = (size_t)8 << 20;
+    unsigned int repeat = 3;
+    bool tsv = false;
+    string outputPath;
+    string filter;
+
+    for (int i = 1; i < argc; i++) {
+        const string option = argv[i];
+        if ((option == "--size" || option == "--repeat" || option == "--output") && i + 1 < argc) {
+            const string value = argv[++i];
+            if (option == "--output") {
+                outputPath = value;
+                continue;
+            }
+            char *end = nullptr;
+            const unsigned long long n = std::strtoull(value.c_str(), &end, 10);
+            if (*end != '\0' || n == 0) {
+                usage();
+                return 2;
+            }
+            if (option == "--size") {
+                size = (size_t)n;
+            } else {
+                repeat = (unsigned int)n;
+            }
+        } else if (option == "--tsv") {
+            tsv = true;
+        } else if (option[0] != '-' && filter.empty()) {
+            filter = option;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::trunc);
+        if (!file) {
+            std::cerr << "RegexBenchmark: can not open " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    Output output(outputPath.empty() ? std::cout : file, tsv);
+
+    std::mt19937 random(20261018);
+    const vector<pair<string, string>> corpora = {
+        {"log", generateLog(size, random)},
+        {"dna", generateDNA(size, random)},
+        {"text", generateText(size, random)},
+    };
+
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    output.write({
+        {"type", "\"run\""},
+        {"format_version", std::to_string(FormatVersion)},
+        {"date", jsonString(date)},
+#ifdef __VERSION__
+        {"compiler", jsonString(__VERSION__)},
+#endif
+#ifdef NDEBUG
+        {"assertions", "false"},
+#else
+        {"assertions", "true"},
+#endif
+        {"corpus_bytes", std::to_string(size)},
+        {"repeat", std::to_string(repeat)},
+        {"hardware_threads", std::to_string(std::thread::hardware_concurrency())},
+    });
+
+    bool failed = false;
+    for (const Case& c : Cases) {
+        if (!filter.empty() && string(c.name).find(filter) == string::npos) { continue; }
+
+        const string& corpus = std::find_if(corpora.begin(), corpora.end(), [&](const auto& p) { return p.first == c.corpus; })->second;
+        vector<std::string_view> lines;
+        for (size_t begin = 0; begin < corpus.size(); ) {
+            size_t end = corpus.find('\n', begin);
+            end = end == string::npos ? corpus.size() : end;
+            lines.push_back(std::string_view(corpus).substr(begin, end - begin));
+            begin = end + 1;
+        }
+
+        const Record record = runCaseInChild(c, corpus, lines, repeat);
+        failed = failed || record[0].second != "\"case\"";
+        output.write(record);
+    }
+
+    return failed ? 1 : 0;
+}
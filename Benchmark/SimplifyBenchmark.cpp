@@ -0,0 +1,144 @@
+//
+//  SimplifyBenchmark.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+// Compares `DFA::simplify` (Hopcroft) with the former Moore-style refinement on generated DFAs with many equivalent states,
+// and checks that both produce the same minimal automaton.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <queue>
+
+#include "DFA.hpp"
+
+using namespace FAS;
+
+class BenchmarkDFA: public DFA
+{
+public:
+
+    using DFA::DFA;
+
+    void simplifyByHopcroft(void) { simplify(); }
+    void simplifyByMoore(void) { DFA::simplifyByMoore(); }
+    FAState stateCount(void) const { return states; }
+
+    // Whether the parts reachable from start states are the same up to renaming states.
+    bool isIsomorphic(const BenchmarkDFA& d) const
+    {
+        vector<FAState> map(states, StateNotFound);
+        vector<FAState> reverseMap(d.states, StateNotFound);
+        std::queue<pair<FAState, FAState>> pairs;
+
+        map[startState] = d.startState;
+        reverseMap[d.startState] = startState;
+        pairs.push({startState, d.startState});
+
+        while (!pairs.empty()) {
+            auto [s, t] = pairs.front();
+            pairs.pop();
+            if (isAcceptState(s) != d.isAcceptState(t)) { return false; }
+
+            for (FASymbol symbol = 0; symbol < 256; symbol++) {
+                FAState ns = transitResult(s, symbol);
+                FAState nt = d.transitResult(t, symbol);
+                if (map[ns] == StateNotFound && reverseMap[nt] == StateNotFound) {
+                    map[ns] = nt;
+                    reverseMap[nt] = ns;
+                    pairs.push({ns, nt});
+                } else if (map[ns] != nt || reverseMap[nt] != ns) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// A random DFA with `base` states, where every state is copied `copies` times and each copy moves to a random copy of the next state.
+// So the minimal DFA has at most `base` states, while there are `base` × `copies` states before simplifying.
+static BenchmarkDFA makeRedundantDFA(FAState base, FAState copies, FASymbol symbolCount, std::mt19937& random)
+{
+    vector<vector<FAState>> baseTransition(base, vector<FAState>(symbolCount));
+    unordered_set<FAState> baseAcceptStates;
+    for (FAState s = 0; s < base; s++) {
+        for (FASymbol c = 0; c < symbolCount; c++) {
+            baseTransition[s][c] = random() % base;
+        }
+        if (random() % 3 == 0) {
+            baseAcceptStates.insert(s);
+        }
+    }
+
+    vector<unordered_map<FASymbol, FAState>> transition(base * copies);
+    unordered_set<FAState> acceptStates;
+    for (FAState s = 0; s < base * copies; s++) {
+        for (FASymbol c = 0; c < symbolCount; c++) {
+            transition[s]['a' + c] = baseTransition[s % base][c] + base * (random() % copies);
+        }
+        if (baseAcceptStates.contains(s % base)) {
+            acceptStates.insert(s);
+        }
+    }
+
+    return BenchmarkDFA(base * copies, {{'a', 'a' + symbolCount - 1}}, 0, acceptStates, transition);
+}
+
+// Counts symbols modulo `states`, and accepts when the count is a multiple of `divisor`, so the minimal DFA has `divisor` states.
+static BenchmarkDFA makeCounterDFA(FAState states, FAState divisor)
+{
+    vector<unordered_map<FASymbol, FAState>> transition(states);
+    unordered_set<FAState> acceptStates;
+    for (FAState s = 0; s < states; s++) {
+        transition[s]['a'] = (s + 1) % states;
+        transition[s]['b'] = s;
+        if (s % divisor == 0) {
+            acceptStates.insert(s);
+        }
+    }
+    return BenchmarkDFA(states, {{'a', 'b'}}, 0, acceptStates, transition);
+}
+
+static double measure(BenchmarkDFA& d, void (BenchmarkDFA::*simplify)(void))
+{
+    auto begin = std::chrono::steady_clock::now();
+    (d.*simplify)();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static void run(const string& name, const BenchmarkDFA& d)
+{
+    BenchmarkDFA moore = d;
+    BenchmarkDFA hopcroft = d;
+    double mooreTime = measure(moore, &BenchmarkDFA::simplifyByMoore);
+    double hopcroftTime = measure(hopcroft, &BenchmarkDFA::simplifyByHopcroft);
+
+    std::cout << name << "\t" << d.stateCount() << "\t" << moore.stateCount() << "\t" << hopcroft.stateCount() << "\t"
+              << mooreTime << "\t" << hopcroftTime << "\t" << (hopcroft.isIsomorphic(moore) ? "same" : "DIFFERENT") << std::endl;
+}
+
+int main()
+{
+    std::mt19937 random(20240313);
+
+    std::cout << "dfa\tstates\tmoore_states\thopcroft_states\tmoore_ms\thopcroft_ms\tresult" << std::endl;
+
+    for (FAState copies : {2, 8, 32}) {
+        for (FAState base : {16, 64, 256}) {
+            run("redundant-" + std::to_string(base) + "x" + std::to_string(copies), makeRedundantDFA(base, copies, 16, random));
+        }
+    }
+    for (FAState states : {256, 1024, 4096}) {
+        run("counter-" + std::to_string(states) + "/16", makeCounterDFA(states, 16));
+    }
+    // Each round of refinement only separates one more state here, which is the worst case of Moore's algorithm.
+    for (FAState states : {256, 1024, 4096}) {
+        run("counter-" + std::to_string(states) + "/" + std::to_string(states), makeCounterDFA(states, states));
+    }
+
+    return 0;
+}
@@ -5,10 +5,15 @@
 //  Created by Min on 2024/3/17.
 //
 
-#include "HashValue.h"
+#include <algorithm>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "BitNumber.hpp"
 
-BitNumber::BitNumber(): segmentCount(0), bits(nullptr) {}
+BitNumber::BitNumber(): segmentCount(0), capacity(InlineSegments), bits(inlineBits) {}
 
 BitNumber::BitNumber(unsigned int position): BitNumber()
 {
@@ -17,94 +22,74 @@ BitNumber::BitNumber(unsigned int position): BitNumber()
 
 BitNumber::BitNumber(const vector<unsigned int>& positions): BitNumber()
 {
-    for (auto pos : positions) {
-        set(pos);
-    }
+    assign(positions);
 }
 
 BitNumber::BitNumber(const unordered_set<unsigned int>& positions): BitNumber()
 {
+    assign(positions);
+}
+
+template <typename Container>
+void BitNumber::assign(const Container& positions)
+{
+    // Grow once for the highest position, instead of once for every higher bit.
+    if (positions.empty()) { return; }
+    reserve(*std::max_element(positions.begin(), positions.end()) / SegmentBits + 1);
     for (auto pos : positions) {
         set(pos);
     }
 }
 
-BitNumber::BitNumber(const BitNumber &n)
+BitNumber::BitNumber(const BitNumber &n): BitNumber()
 {
-    if (this == &n) { return; }
-    segmentCount = n.segmentCount;
-    if (segmentCount > 0) {
-        bits = new unsigned int[segmentCount];
-        memcpy(bits, n.bits, segmentCount * sizeof(unsigned int));
-    } else {
-        bits = nullptr;
-    }
+    *this = n;
 }
 
-BitNumber::BitNumber(BitNumber &&n)
+BitNumber::BitNumber(BitNumber &&n): BitNumber()
 {
-    if (this == &n) {
-        assert(1);
-        return;
-    }
-
-    segmentCount = n.segmentCount;
-    bits = n.bits;
-    n.segmentCount = 0;
-    n.bits = nullptr;
+    *this = std::move(n);
 }
 
 BitNumber& BitNumber::operator=(const BitNumber &n)
 {
     if (this == &n) { return *this; }
+    segmentCount = 0;
+    reserve(n.segmentCount);
     segmentCount = n.segmentCount;
-    if (bits) {
-        delete[] bits;
-    }
-    if (segmentCount > 0) {
-        bits = new unsigned int[segmentCount];
-        memcpy(bits, n.bits, segmentCount * sizeof(unsigned int));
-    } else {
-        bits = nullptr;
-    }
+    memcpy(bits, n.bits, segmentCount * sizeof(uint64_t));
     return *this;
 }
 
 BitNumber& BitNumber::operator=(BitNumber &&n)
 {
-    if (this == &n) {
-        assert(1);
-        return *this;
-    }
-
-    segmentCount = n.segmentCount;
-    if (bits) {
-        delete[] bits;
+    if (this == &n) { return *this; }
+    if (n.isInline()) {
+        *this = n;
+    } else {
+        if (!isInline()) {
+            delete[] bits;
+        }
+        segmentCount = n.segmentCount;
+        capacity = n.capacity;
+        bits = n.bits;
+        n.segmentCount = 0;
+        n.capacity = InlineSegments;
+        n.bits = n.inlineBits;
     }
-    bits = n.bits;
-    n.segmentCount = 0;
-    n.bits = nullptr;
     return *this;
 }
 
 BitNumber::~BitNumber()
 {
-    if (bits) {
+    if (!isInline()) {
         delete[] bits;
     }
 }
 
 bool BitNumber::operator==(const BitNumber& n) const
 {
-    if (segmentCount == n.segmentCount) {
-        for (int i = 0; i < segmentCount; i++) {
-            if (bits[i] != n.bits[i]) {
-                return false;
-            }
-        }
-        return true;
-    }
-    return false;
+    return segmentCount == n.segmentCount && memcmp(bits, n.bits, segmentCount * sizeof(uint64_t)) == 0;
 }
 
 // set the bit of position to 1
@@ -119,37 +104,71 @@ void BitNumber::clear(unsigned int position)
     set(position, 0);
 }
 
+void BitNumber::reserve(unsigned int segments)
+{
+    if (segments <= capacity) { return; }
+
+    // Doubling keeps setting ascending positions linear.
+    capacity = std::max(segments, capacity * 2);
+    uint64_t *data = new uint64_t[capacity];
+    memcpy(data, bits, segmentCount * sizeof(uint64_t));
+    if (!isInline()) {
+        delete[] bits;
+    }
+    bits = data;
+}
+
 void BitNumber::set(unsigned int position, bool value)
 {
     unsigned int index = position / SegmentBits;
     unsigned int pos = position % SegmentBits;
 
     if (index >= segmentCount) {
-        unsigned int *data = new unsigned int[index + 1]();
-        if (bits) {
-            memcpy(data, bits, segmentCount * sizeof(unsigned int));
-            delete [] bits;
-        }
+        if (!value) { return; }
+        reserve(index + 1);
+        memset(bits + segmentCount, 0, (index + 1 - segmentCount) * sizeof(uint64_t));
         segmentCount = index + 1;
-        bits = data;
-        data = nullptr;
     }
 
     if (value) {
-        bits[index] |= 1 << pos;
+        bits[index] |= (uint64_t)1 << pos;
     } else {
-        bits[index] &= ~(1 << pos);
+        bits[index] &= ~((uint64_t)1 << pos);
+        while (segmentCount > 0 && bits[segmentCount - 1] == 0) {
+            segmentCount--;
+        }
     }
 }
 
-const unsigned int BitNumber::hashValue() const
+// The multiply-and-fold mixing of wyhash: the full 128-bit product of two words, with its halves xored.
+// `__uint128_t` is a GCC and Clang extension on 64-bit targets, so MSVC uses its intrinsic, and other targets multiply 32-bit halves, which gives the same product.
+static inline uint64_t mix(const uint64_t a, const uint64_t b)
 {
-    unsigned int res = 0;
-    if (segmentCount) {
-        res ^= bits[0];
-        if (segmentCount > 1) {
-            res ^= bits[segmentCount - 1];
-        }
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    const uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    const uint64_t aLow = (uint32_t)a, aHigh = a >> 32, bLow = (uint32_t)b, bHigh = b >> 32;
+    const uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+    const uint64_t middle = (lowLow >> 32) + (uint32_t)lowHigh + (uint32_t)highLow;
+    const uint64_t low = (middle << 32) | (uint32_t)lowLow;
+    const uint64_t high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+size_t BitNumber::hashValue() const
+{
+    const uint64_t Secret0 = 0xa0761d6478bd642full;
+    const uint64_t Secret1 = 0xe7037ed1a0b428dbull;
+
+    uint64_t res = Secret0 ^ segmentCount;
+    for (unsigned int i = 0; i < segmentCount; i++) {
+        res = mix(bits[i] ^ Secret1, res ^ Secret0);
     }
-    return res;
+    return (size_t)mix(res ^ Secret1, segmentCount ^ Secret0);
 }
@@ -8,28 +8,43 @@
 #ifndef BitNumber_hpp
 #define BitNumber_hpp
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <unordered_set>
 
 using std::vector;
 using std::unordered_set;
 
+// A set of states as a number, used as the key of subsets during subset construction.
+// Sets of up to `InlineSegments` * 64 states live inside the number, so most keys never allocate.
 struct BitNumber
 {
 private:
 
-    const static unsigned int SegmentBits = sizeof(unsigned int) * 8;
+    static constexpr unsigned int SegmentBits = sizeof(uint64_t) * 8;
+    static constexpr unsigned int InlineSegments = 4;
 
-    unsigned int segmentCount;
-    unsigned int *bits;
+    unsigned int segmentCount; // The last segment is never 0, so equal sets have equal segments.
+    unsigned int capacity;
+    uint64_t *bits; // `inlineBits`, or a buffer of `capacity` segments on the heap.
+    uint64_t inlineBits[InlineSegments];
+
+    bool isInline(void) const { return bits == inlineBits; }
+
+    // make room for `segments` segments, keeping the current ones
+    void reserve(unsigned int segments);
 
     // set the bit of position to 0 or 1
     void set(unsigned int position, bool value);
 
+    template <typename Container>
+    void assign(const Container& positions);
+
 public:
 
     BitNumber();
-    
+
     // init a number whose bits are all 0 except the bit of position
     BitNumber(unsigned int position);
 
@@ -53,7 +68,8 @@ public:
     // set the bit of position to 0
     void clear(unsigned int position);
 
-    const unsigned int hashValue() const;
+    // Mixes every segment, so sets differing in any bit hash apart.
+    size_t hashValue() const;
 };
 
 namespace std {
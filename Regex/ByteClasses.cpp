@@ -0,0 +1,61 @@
+//
+//  ByteClasses.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ByteClasses.hpp"
+
+using namespace FAS;
+
+ByteClasses::ByteClasses(): count(1)
+{
+    classes.fill(0);
+}
+
+ByteClasses::ByteClasses(const std::array<unsigned char, SymbolCount>& classes): classes(classes), count(0)
+{
+    std::array<bool, SymbolCount> used{};
+    for (unsigned char c : classes) {
+        used[c] = true;
+        count = std::max(count, (unsigned int)c + 1);
+    }
+    if (std::find(used.begin(), used.begin() + count, false) != used.begin() + count) {
+        throw std::invalid_argument("byte classes are not numbered without gaps");
+    }
+}
+
+void ByteClasses::refine(const vector<unsigned int>& labels)
+{
+    // Every distinct (class, label) pair becomes a new class, and new classes are numbered in order of their smallest symbol.
+    unordered_map<unsigned long long, unsigned int> newClassMap;
+    unsigned long long key;
+
+    for (FASymbol s = 0; s < SymbolCount; s++) {
+        key = ((unsigned long long)labels[s] << 8) | classes[s];
+        auto it = newClassMap.find(key);
+        if (it == newClassMap.end()) {
+            it = newClassMap.emplace(key, (unsigned int)newClassMap.size()).first;
+        }
+        classes[s] = (unsigned char)it->second;
+    }
+    count = (unsigned int)newClassMap.size();
+}
+
+vector<FASymbol> ByteClasses::representatives(void) const
+{
+    vector<FASymbol> result(count, SymbolCount);
+    for (FASymbol s = SymbolCount; s > 0; s--) {
+        result[classes[s - 1]] = s - 1;
+    }
+    return result;
+}
+
+bool ByteClasses::operator==(const ByteClasses& c) const
+{
+    return count == c.count && classes == c.classes;
+}
@@ -0,0 +1,50 @@
+//
+//  ByteClasses.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef ByteClasses_hpp
+#define ByteClasses_hpp
+
+#include <array>
+
+#include "FA.hpp"
+
+namespace FAS
+{
+
+// Groups byte symbols into equivalence classes, two symbols share a class only if every transition treats them the same.
+// So an automaton only needs one column for each class instead of each symbol, for example all of `a`-`z` but the literals in a pattern are usually one class.
+class ByteClasses
+{
+private:
+
+    std::array<unsigned char, 256> classes; // classes[symbol] is the class of the symbol.
+    unsigned int count;
+
+public:
+
+    static constexpr unsigned int SymbolCount = 256; // Only byte symbols can be classified, which are all that a string can provide.
+
+    // Init with all symbols in one class.
+    ByteClasses();
+    // Init with `classes`[symbol] as the class of each symbol, which are numbered from 0 without gaps. Throws `std::invalid_argument` if there is a gap.
+    ByteClasses(const std::array<unsigned char, SymbolCount>& classes);
+
+    // Split classes so that symbols with different `labels` are never in one class, `labels` must have `SymbolCount` elements.
+    void refine(const vector<unsigned int>& labels);
+
+    unsigned int classOf(const FASymbol symbol) const { return classes[symbol]; }
+    unsigned int classCount(void) const { return count; }
+
+    // The smallest symbol of each class.
+    vector<FASymbol> representatives(void) const;
+
+    bool operator==(const ByteClasses& c) const;
+};
+
+}
+
+#endif /* ByteClasses_hpp */
@@ -0,0 +1,60 @@
+//
+//  ByteSearch.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef ByteSearch_hpp
+#define ByteSearch_hpp
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace FAS
+{
+
+// Find the first byte in [begin, end) equal to any of `bytes`[0, count) where count <= 3, or `end` if there is none.
+// One byte is left to `memchr`, two or three bytes are compared 16 at a time with SSE2 when it is available.
+inline const unsigned char *findAnyByte(const unsigned char *begin, const unsigned char *end, const unsigned char *bytes, const unsigned int count)
+{
+    if (count == 0) {
+        return end;
+    }
+    if (count == 1) {
+        const void *found = memchr(begin, bytes[0], end - begin);
+        return found != nullptr ? static_cast<const unsigned char *>(found) : end;
+    }
+
+    // With two bytes, the last one is compared twice.
+    const unsigned char b0 = bytes[0], b1 = bytes[1], b2 = bytes[count - 1];
+
+#if defined(__SSE2__)
+    const __m128i v0 = _mm_set1_epi8((char)b0);
+    const __m128i v1 = _mm_set1_epi8((char)b1);
+    const __m128i v2 = _mm_set1_epi8((char)b2);
+    while (end - begin >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const __m128i equal = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, v0), _mm_cmpeq_epi8(chunk, v1)), _mm_cmpeq_epi8(chunk, v2));
+        const int mask = _mm_movemask_epi8(equal);
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+#endif
+
+    for (; begin < end; begin++) {
+        if (*begin == b0 || *begin == b1 || *begin == b2) {
+            return begin;
+        }
+    }
+    return end;
+}
+
+}
+
+#endif /* ByteSearch_hpp */
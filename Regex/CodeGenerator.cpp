@@ -0,0 +1,268 @@
+//
+//  CodeGenerator.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "CodeGenerator.hpp"
+#include "DFA.hpp"
+
+using namespace FAS;
+
+CodeGenerator::CodeGenerator(const DFA& d): CodeGenerator(DenseDFA(d)) {}
+
+CodeGenerator::CodeGenerator(const DenseDFA& d): states(d.states), startState(d.startState), firstAcceptState(d.firstAcceptState), alphabetSize(d.alphabetSize), transition((size_t)d.states * d.alphabetSize)
+{
+    for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+        classOf[symbol] = (unsigned char)d.byteClasses.classOf(symbol);
+    }
+    for (size_t i = 0; i < transition.size(); i++) {
+        switch (d.stateWidth) {
+            case 1: transition[i] = d.table[i]; break;
+            case 2: transition[i] = reinterpret_cast<const uint16_t *>(d.table)[i]; break;
+            default: transition[i] = reinterpret_cast<const uint32_t *>(d.table)[i]; break;
+        }
+    }
+}
+
+static string byteLiteral(const unsigned int c)
+{
+    if (std::isalnum(c)) {
+        return string("'") + (char)c + "'";
+    }
+    std::ostringstream out;
+    out << "0x" << std::hex << std::setw(2) << std::setfill('0') << c;
+    return out.str();
+}
+
+template <typename T>
+static void generateArray(std::ostream& out, const string& type, const string& name, const T& values)
+{
+    out << "inline constexpr " << type << " " << name << "[] = {";
+    for (size_t i = 0; i < values.size(); i++) {
+        out << (i % 16 == 0 ? "\n    " : " ") << (unsigned long)values[i] << ",";
+    }
+    out << "\n};\n\n";
+}
+
+void CodeGenerator::generate(std::ostream& out, const string& name, const Style style) const
+{
+    bool valid = !name.empty() && !std::isdigit((unsigned char)name[0]);
+    for (const char c : name) {
+        valid = valid && (std::isalnum((unsigned char)c) || c == '_');
+    }
+    if (!valid) {
+        throw std::invalid_argument("not an identifier: " + name);
+    }
+
+    string guard = name + "_hpp";
+    out << "// Generated by FAS::CodeGenerator, do not edit.\n\n";
+    out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    out << "#include <cstddef>\n#include <cstdint>\n#include <utility>\n#include <vector>\n\n";
+    out << "namespace " << name << "\n{\n\n";
+    out << "typedef std::pair<unsigned int, unsigned int> Substring; // Position and length.\n\n";
+    out << "inline constexpr unsigned int DeadState = 0;\n";
+    out << "inline constexpr unsigned int StartState = " << startState << ";\n";
+    out << "inline constexpr unsigned int FirstAcceptState = " << firstAcceptState << ";\n\n";
+
+    switch (style) {
+        case Tables: generateTables(out); break;
+        case Goto: generateGoto(out); break;
+    }
+
+    out << "}\n\n#endif\n";
+    if (!out) {
+        throw std::runtime_error("failed to write generated code");
+    }
+}
+
+void CodeGenerator::generate(const string& path, const string& name, const Style style) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("can not open " + path);
+    }
+    generate(out, name, style);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+void CodeGenerator::generateTables(std::ostream& out) const
+{
+    const string stateType = states <= UINT8_MAX + 1 ? "uint8_t" : (states <= UINT16_MAX + 1 ? "uint16_t" : "uint32_t");
+    out << "inline constexpr unsigned int AlphabetSize = " << alphabetSize << ";\n\n";
+    generateArray(out, "unsigned char", "classOf", classOf);
+    generateArray(out, stateType, "table", transition);
+
+    // Same loops as `DenseDFA`, without prefilters and acceleration.
+    out << R"(inline bool recognize(const char *data, const size_t size)
+{
+    const unsigned char *parser = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char *const end = parser + size;
+    unsigned int state = StartState;
+    while (parser < end && state != DeadState) {
+        state = table[state * AlphabetSize + classOf[*parser++]];
+    }
+    return state >= FirstAcceptState;
+}
+
+inline std::vector<Substring> find(const char *data, const size_t size)
+{
+    const unsigned int NothingMatched = -1;
+
+    std::vector<Substring> result;
+    if (StartState == DeadState) { return result; }
+
+    const unsigned char *const begin = reinterpret_cast<const unsigned char *>(data);
+    unsigned int matchBegin = 0;
+    unsigned int matchedLength = StartState >= FirstAcceptState ? 0 : NothingMatched;
+    unsigned int state = StartState;
+    bool beginFromStartState = false;
+
+    unsigned int parser = 0;
+    while (parser < size) {
+        const unsigned int next = table[state * AlphabetSize + classOf[begin[parser]]];
+        if (next == DeadState) {
+            if (matchedLength != NothingMatched) {
+                result.push_back({matchBegin, matchedLength});
+            }
+            if (beginFromStartState) {
+                parser++;
+            }
+            beginFromStartState = true;
+            state = StartState;
+            matchBegin = parser;
+            matchedLength = NothingMatched;
+        } else {
+            beginFromStartState = false;
+            parser++;
+            state = next;
+            if (state >= FirstAcceptState) {
+                matchedLength = parser - matchBegin;
+            }
+        }
+    }
+
+    if (matchedLength != NothingMatched) {
+        result.push_back({matchBegin, matchedLength});
+    }
+    return result;
+}
+
+)";
+}
+
+template <typename Action>
+void CodeGenerator::generateSwitch(std::ostream& out, const FAState state, const string& subject, Action action) const
+{
+    // The most common target is the default, which is usually `DeadState` or a loop.
+    vector<unsigned int> counts(states, 0);
+    for (unsigned int symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+        counts[next(state, symbol)]++;
+    }
+    FAState defaultTarget = 0;
+    for (FAState t = 0; t < states; t++) {
+        if (counts[t] > counts[defaultTarget]) {
+            defaultTarget = t;
+        }
+    }
+
+    out << "    switch (" << subject << ") {\n";
+    for (FAState t = 0; t < states; t++) {
+        if (t == defaultTarget || counts[t] == 0) { continue; }
+        unsigned int written = 0;
+        for (unsigned int symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+            if (next(state, symbol) != t) { continue; }
+            out << (written % 8 == 0 ? "        " : " ") << "case " << byteLiteral(symbol) << ":";
+            written++;
+            if (written % 8 == 0 || written == counts[t]) {
+                out << "\n";
+            }
+        }
+        out << "            " << action(t) << "\n";
+    }
+    out << "        default:\n            " << action(defaultTarget) << "\n    }\n\n";
+}
+
+void CodeGenerator::generateGoto(std::ostream& out) const
+{
+    auto label = [](const FAState state) { return "s" + std::to_string(state); };
+
+    out << "inline bool recognize(const char *data, const size_t size)\n{\n";
+    if (startState == DenseDFA::DeadState) {
+        out << "    (void)data;\n    (void)size;\n    return false;\n}\n\n";
+    } else {
+        out << "    const unsigned char *parser = reinterpret_cast<const unsigned char *>(data);\n";
+        out << "    const unsigned char *const end = parser + size;\n";
+        out << "    goto " << label(startState) << ";\n\n";
+        for (FAState s = 1; s < states; s++) {
+            out << label(s) << ":\n";
+            out << "    if (parser == end) { return " << (s >= firstAcceptState ? "true" : "false") << "; }\n";
+            generateSwitch(out, s, "*parser++", [&](const FAState t) {
+                return t == DenseDFA::DeadState ? string("return false;") : "goto " + label(t) + ";";
+            });
+        }
+        out << "}\n\n";
+    }
+
+    // Same as the loop of `DenseDFA::findRecognizedSubstrings`, where a transition to an accept state records the match, and `dead` restarts after it.
+    out << "inline std::vector<Substring> find(const char *data, const size_t size)\n{\n";
+    out << "    std::vector<Substring> result;\n";
+    if (startState == DenseDFA::DeadState) {
+        out << "    (void)data;\n    (void)size;\n    return result;\n}\n\n";
+        return;
+    }
+    out << "    const unsigned char *const begin = reinterpret_cast<const unsigned char *>(data);\n";
+    out << "    const unsigned char *const end = begin + size;\n";
+    out << "    const unsigned char *parser = begin;\n";
+    out << "    const unsigned char *matchBegin = begin;\n";
+    out << "    const unsigned char *matchEnd = " << (startState >= firstAcceptState ? "begin" : "nullptr") << ";\n";
+    // Without a transition to the dead state, like in `(.|\n)*`, the restart is left out, since an unused label is a warning.
+    const bool reachesDead = std::find(transition.begin() + alphabetSize, transition.end(), DenseDFA::DeadState) != transition.end();
+    if (reachesDead) {
+        out << "    bool beginFromStartState = false;\n";
+    }
+    out << "    goto " << label(startState) << ";\n\n";
+    for (FAState s = 1; s < states; s++) {
+        out << label(s) << ":\n";
+        out << "    if (parser == end) { goto finish; }\n";
+        generateSwitch(out, s, "*parser", [&](const FAState t) {
+            if (t == DenseDFA::DeadState) {
+                return string("goto dead;");
+            }
+            return string("parser++; ") + (reachesDead ? "beginFromStartState = false; " : "") + (t >= firstAcceptState ? "matchEnd = parser; " : "") + "goto " + label(t) + ";";
+        });
+    }
+    if (reachesDead) {
+        out << R"(dead:
+    if (matchEnd) {
+        result.push_back({(unsigned int)(matchBegin - begin), (unsigned int)(matchEnd - matchBegin)});
+    }
+    if (beginFromStartState) {
+        parser++;
+    }
+    beginFromStartState = true;
+    matchBegin = parser;
+    matchEnd = nullptr;
+)";
+        out << "    goto " << label(startState) << ";\n\n";
+    }
+    out << R"(finish:
+    if (matchEnd) {
+        result.push_back({(unsigned int)(matchBegin - begin), (unsigned int)(matchEnd - matchBegin)});
+    }
+    return result;
+}
+
+)";
+}
@@ -0,0 +1,64 @@
+//
+//  CodeGenerator.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef CodeGenerator_hpp
+#define CodeGenerator_hpp
+
+#include <array>
+#include <ostream>
+
+#include "DenseDFA.hpp"
+
+namespace FAS
+{
+
+class DFA;
+
+// Writes an automaton as a standalone C++ header, which defines `recognize` and `find` in a namespace and does not depend on `FAS`, so it is compiled with the code using it and optimized like it.
+// Generated functions have the semantics of `DenseDFA::recognize` and `DenseDFA::findRecognizedSubstrings`, and need C++17.
+class CodeGenerator
+{
+public:
+
+    enum Style
+    {
+        Tables, // A transition table of byte classes scanned by a loop, which stays small for any automaton.
+        Goto, // A label for every state, which switches on the next byte and jumps to the next state, like re2c. It is usually faster for small automata, but its code grows with the count of transitions.
+    };
+
+private:
+
+    FAState states;
+    FAState startState;
+    FAState firstAcceptState;
+    unsigned int alphabetSize;
+    std::array<unsigned char, ByteClasses::SymbolCount> classOf;
+    vector<FAState> transition; // transition[state * alphabetSize + class], numbered like `DenseDFA`.
+
+    FAState next(const FAState state, const unsigned int symbol) const { return transition[(size_t)state * alphabetSize + classOf[symbol]]; }
+
+    void generateTables(std::ostream& out) const;
+    void generateGoto(std::ostream& out) const;
+    // The cases of `state` in a switch on the next byte, with `action(target)` as the statement for every target state.
+    template <typename Action>
+    void generateSwitch(std::ostream& out, const FAState state, const string& subject, Action action) const;
+
+public:
+
+    // `d` is expected to be simplified already, like `DenseDFA` expects.
+    CodeGenerator(const DFA& d);
+    CodeGenerator(const DenseDFA& d);
+
+    // `name` is the namespace of the generated functions, which must be a C++ identifier. Throws `std::invalid_argument` if it is not, or `std::runtime_error` if writing fails.
+    void generate(std::ostream& out, const string& name, const Style style = Tables) const;
+    void generate(const string& path, const string& name, const Style style = Tables) const;
+
+};
+
+}
+
+#endif /* CodeGenerator_hpp */
@@ -0,0 +1,50 @@
+//
+//  ConstructionArena.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+#include "ConstructionArena.hpp"
+
+using namespace FAS;
+
+ConstructionArena::ConstructionArena(const size_t initialBlockSize): previous(currentArena), nextBlockSize(std::max(initialBlockSize, (size_t)1024))
+{
+    currentArena = this;
+}
+
+ConstructionArena::~ConstructionArena()
+{
+    assert(currentArena == this);
+    currentArena = previous;
+    while (blocks) {
+        Block *next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+}
+
+void *ConstructionArena::allocateBlock(const size_t size, const size_t alignment)
+{
+    // Blocks double up to `MaxBlockSize`, so the count of blocks stays logarithmic, and a larger request gets a block of its own.
+    const size_t needed = sizeof(Block) + alignment + size;
+    const size_t blockSize = std::max(nextBlockSize, needed);
+    nextBlockSize = std::min(nextBlockSize * 2, MaxBlockSize);
+
+    Block *block = static_cast<Block *>(::operator new(blockSize));
+    block->next = blocks;
+    block->size = blockSize;
+    blocks = block;
+    usage += blockSize;
+
+    unsigned char *begin = reinterpret_cast<unsigned char *>(block + 1);
+    unsigned char *p = begin + (-(uintptr_t)begin & (alignment - 1));
+    cursor = p + size;
+    limit = reinterpret_cast<unsigned char *>(block) + blockSize;
+    return p;
+}
@@ -0,0 +1,170 @@
+//
+//  ConstructionArena.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef ConstructionArena_hpp
+#define ConstructionArena_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace FAS
+{
+
+// A monotonic arena for constructing automata. While it is alive, containers of construction (`NFA` transitions, `DFA` rows, and the temporaries of determinizing and minimizing) created on its thread allocate from it by bumping a pointer, and it releases them all at once when it is destroyed.
+// Construct one around compiling, and keep only what does not allocate from it:
+//
+//     ConstructionArena arena;
+//     DenseDFA dense{DFA{NFA{pattern}}};
+//
+// An automaton allocates where it is constructed, even if it is changed in the scope of another arena. `DenseDFA` and copies allocate from the heap, but automata constructed or moved in the scope must not outlive it. Arenas nest, are used only on their own thread, and must be destroyed in reverse order of construction.
+// Memory freed within a step of construction is only reused after the step, see `ScratchArena`, so an arena may peak higher than the heap for automata of many thousands of states, in exchange for no per-node malloc and no fragmentation left behind.
+class ConstructionArena
+{
+private:
+
+    static constexpr size_t DefaultBlockSize = (size_t)64 << 10;
+    static constexpr size_t MaxBlockSize = (size_t)16 << 20;
+
+    struct Block
+    {
+        Block *next;
+        size_t size;
+    };
+
+    static inline thread_local ConstructionArena *currentArena = nullptr;
+
+    ConstructionArena *previous;
+    Block *blocks = nullptr;
+    unsigned char *cursor = nullptr;
+    unsigned char *limit = nullptr;
+    size_t nextBlockSize;
+    size_t usage = 0;
+
+    // Start a block for at least `size` bytes aligned to `alignment`.
+    void *allocateBlock(const size_t size, const size_t alignment);
+
+public:
+
+    ConstructionArena(const size_t initialBlockSize = DefaultBlockSize);
+    ~ConstructionArena();
+
+    ConstructionArena(const ConstructionArena&) = delete;
+    ConstructionArena& operator=(const ConstructionArena&) = delete;
+
+    void *allocate(const size_t size, const size_t alignment)
+    {
+        unsigned char *p = cursor + (-(uintptr_t)cursor & (alignment - 1));
+        if (p > limit || (size_t)(limit - p) < size) {
+            return allocateBlock(size, alignment);
+        }
+        cursor = p + size;
+        return p;
+    }
+
+    // Bytes taken from the heap for blocks.
+    size_t memoryUsage(void) const { return usage; }
+
+    // The innermost arena alive on this thread, or nullptr.
+    static ConstructionArena *current(void) { return currentArena; }
+};
+
+// An arena of its own for the temporaries of one step of construction, if construction is on an arena already, so they are released when the step ends rather than with the outer arena.
+// Without an arena, temporaries stay on the heap and are freed one by one as before.
+class ScratchArena
+{
+private:
+
+    std::optional<ConstructionArena> arena;
+
+public:
+
+    ScratchArena()
+    {
+        if (ConstructionArena::current()) {
+            arena.emplace();
+        }
+    }
+};
+
+// Allocates from the `ConstructionArena` current when the container is created, or from the heap without one. Memory of an arena is never freed one by one.
+// Like `std::pmr::polymorphic_allocator`, elements share the allocator of their container, a copied container allocates from the heap, and an assigned one keeps its own allocator, so copying is the way to keep a container beyond its arena.
+template <typename T>
+class ArenaAllocator
+{
+private:
+
+    template <typename U>
+    friend class ArenaAllocator;
+
+    ConstructionArena *arena;
+
+public:
+
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+    typedef std::false_type is_always_equal;
+
+    ArenaAllocator(): arena(ConstructionArena::current()) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& a): arena(a.arena) {}
+
+    T *allocate(const size_t n)
+    {
+        if (arena) {
+            return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, const size_t n)
+    {
+        if (!arena) {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    // Nested containers are given this allocator, so elements always allocate where their container does.
+    template <typename U, typename... Args>
+    void construct(U *p, Args&&... args)
+    {
+        std::uninitialized_construct_using_allocator(p, *this, std::forward<Args>(args)...);
+    }
+
+    ArenaAllocator select_on_container_copy_construction(void) const
+    {
+        ArenaAllocator result;
+        result.arena = nullptr;
+        return result;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& a) const { return arena == a.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& a) const { return arena != a.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename T>
+using ArenaSet = std::unordered_set<T, std::hash<T>, std::equal_to<T>, ArenaAllocator<T>>;
+
+template <typename K, typename V>
+using ArenaMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, ArenaAllocator<std::pair<const K, V>>>;
+
+}
+
+#endif /* ConstructionArena_hpp */
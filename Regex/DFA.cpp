@@ -5,13 +5,12 @@
 //  Created by Min on 2024/3/12.
 //
 
-#include <queue>
+#include <algorithm>
 
 #include "DFA.hpp"
 #include "NFA.hpp"
-#include "BitNumber.hpp"
-
-using std::queue;
+#include "SubsetArena.hpp"
+#include "Minimizer.hpp"
 
 using namespace FAS;
 
@@ -36,9 +35,8 @@ namespace std {
 FAState DFA::transitResult(const FAState state, const FASymbol symbol) const
 {
     if (state < 0 || state >= states) { return StateNotFound; }
-    auto& map = transition[state];
-    if (!map.contains(symbol)) { return StateNotFound; }
-    return map.at(symbol);
+    if (symbol >= ByteClasses::SymbolCount) { return StateNotFound; }
+    return transition[state][byteClasses.classOf(symbol)];
 }
 
 bool DFA::isTerminalState(const FAState state) const
@@ -49,101 +47,137 @@ bool DFA::isTerminalState(const FAState state) const
 void DFA::calculateTerminalStates(void)
 {
     terminalStates = {};
-    bool need;
     for (FAState s = 0; s < states; s++) {
         if (!isAcceptState(s)) {
-            const auto& map = transition[s];
-            need = true;
-            for (auto symbolRange: symbols) {
-                for (auto i = symbolRange.first; i <= symbolRange.second; i++) {
-                    if (map.at(i) != s) {
-                        need = false;
-                        break;
-                    }
-                }
-                if (!need) {
-                    break;
+            const auto& row = transition[s];
+            if (std::all_of(row.begin(), row.end(), [s](FAState t) { return t == s; })) {
+                terminalStates.insert(s);
+            }
+        }
+    }
+}
+
+void DFA::calculatePrefilter(void)
+{
+    ByteFlags killers{};
+    for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+        const FASymbol c = byteClasses.classOf(symbol);
+        bool kills = !terminalStates.empty();
+        for (FAState s = 0; s < states && kills; s++) {
+            kills = isTerminalState(s) || isTerminalState(transition[s][c]);
+        }
+        killers[symbol] = kills;
+    }
+
+    if (requiredLiteral.literal.empty() && startState < states) {
+        // Follow the start state while exactly one symbol leads to a live state, and stop before a state accepting a shorter match.
+        string prefix;
+        vector<bool> visited(states, false);
+        FAState s = startState;
+        while (!isAcceptState(s) && !visited[s] && prefix.size() < 256) {
+            visited[s] = true;
+            FASymbol liveSymbol = 0;
+            unsigned int liveSymbols = 0;
+            for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount && liveSymbols <= 1; symbol++) {
+                if (isSymbolInRange(symbol) && !isTerminalState(transition[s][byteClasses.classOf(symbol)])) {
+                    liveSymbol = symbol;
+                    liveSymbols++;
                 }
             }
-            if (need) {
-                terminalStates.insert(s);
+            if (liveSymbols != 1) { break; }
+            prefix += (char)liveSymbol;
+            s = transition[s][byteClasses.classOf(liveSymbol)];
+        }
+        requiredLiteral = {prefix, true};
+    }
+
+    prefilter = Prefilter(requiredLiteral, killers);
+}
+
+void DFA::compressTransition(const vector<unordered_map<FASymbol, FAState>>& symbolTransition)
+{
+    byteClasses = ByteClasses();
+    vector<unsigned int> labels(ByteClasses::SymbolCount);
+
+    // Symbols leading to the same state get the same label, and label 0 means no transition.
+    for (FAState s = 0; s < states && s < symbolTransition.size(); s++) {
+        std::fill(labels.begin(), labels.end(), 0);
+        for (const auto& pair : symbolTransition[s]) {
+            if (pair.first < ByteClasses::SymbolCount && pair.second < states && isSymbolInRange(pair.first)) {
+                labels[pair.first] = pair.second + 1;
             }
         }
+        byteClasses.refine(labels);
+    }
+
+    vector<FASymbol> representatives = byteClasses.representatives();
+    const FAState deadState = states;
+    bool needDeadState = false;
+
+    transition.assign(states, ArenaVector<FAState>(byteClasses.classCount(), deadState));
+    for (FAState s = 0; s < states && s < symbolTransition.size(); s++) {
+        for (FASymbol c = 0; c < byteClasses.classCount(); c++) {
+            auto it = symbolTransition[s].find(representatives[c]);
+            if (it != symbolTransition[s].end() && it->second < states && isSymbolInRange(it->first)) {
+                transition[s][c] = it->second;
+            } else {
+                needDeadState = true;
+            }
+        }
+    }
+    needDeadState = needDeadState || symbolTransition.size() < states;
+
+    if (needDeadState) {
+        transition.emplace_back(byteClasses.classCount(), deadState);
+        states++;
     }
 }
 
 DFA::DFA(): DFA(0, 0, {}, {}) {}
 
-DFA::DFA(const FAState states, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, FAState>>& transition): FA(states, startState, acceptStates), currentState(startState), transition(transition)
+DFA::DFA(const FAState states, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, FAState>>& transition): FA(states, startState, acceptStates), currentState(startState)
 {
+    compressTransition(transition);
     calculateTerminalStates();
+    calculatePrefilter();
 }
 
-DFA::DFA(const FAState states, const vector<pair<FASymbol, FASymbol>>& symbols, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, FAState>>& transition): FA(states, symbols, startState, acceptStates), currentState(startState), transition(transition)
+DFA::DFA(const FAState states, const vector<pair<FASymbol, FASymbol>>& symbols, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, FAState>>& transition): FA(states, symbols, startState, acceptStates), currentState(startState)
 {
+    compressTransition(transition);
     calculateTerminalStates();
+    calculatePrefilter();
 }
 
 DFA::DFA(const NFA& n): DFA(std::move(n)) {}
 
 DFA::DFA(const NFA&& n)
+{
+    determinize(n);
+    simplify();
+}
+
+void DFA::determinize(const NFA& n)
 {
     symbols = n.symbols;
+    requiredLiteral = n.requiredLiteral;
     startState = 0;
     currentState = 0;
     acceptStates = {};
     transition = {};
-
-    unordered_map<FAState, unordered_map<FASymbol, BitNumber>> tempTransition;
-    queue<unordered_set<FAState>> statesQueue;
-    statesQueue.push(n.collectEmptySymbolReachableStates({startState}));
-
-    FAState index = 0;
-    unordered_map<BitNumber, FAState> stateMap;
-
-    unordered_set<FAState> stateSet;
-    unordered_set<FAState> tempStateSet;
-    BitNumber stateNumber;
-
-    while (!statesQueue.empty()) {
-
-        stateSet = statesQueue.front();
-        statesQueue.pop();
-        stateNumber = BitNumber(stateSet);
-
-        if (!stateMap.contains(stateNumber)) {
-
-            stateMap[stateNumber] = index;
-            if (n.containAcceptStates(stateSet)) {
-                acceptStates.insert(index);
-            }
-
-            for (auto symbolRange: symbols) {
-                for (auto i = symbolRange.first; i <= symbolRange.second; i++) {
-                    tempStateSet = n.collectEmptySymbolReachableStates(n.transitResult(stateSet, i));
-                    statesQueue.push(tempStateSet);
-                    tempTransition[index][i] = BitNumber(tempStateSet);
-                }
-            }
-
-            index++;
-        }
-    }
-
-    unordered_map<FASymbol, FAState> tempMap;
-    for (FAState i = 0; i < index; i++) {
-        for (auto symbolRange: symbols) {
-            for (auto j = symbolRange.first; j <= symbolRange.second; j++) {
-                tempMap[j] = stateMap[tempTransition[i][j]];
-            }
+    byteClasses = n.calculateByteClasses();
+
+    // Subsets are only needed while determinizing. `transition` keeps the allocator it was constructed with.
+    ScratchArena scratch;
+    SubsetArena subsets;
+    n.determinize(byteClasses, subsets, transition);
+    for (FAState id = 0; id < subsets.size(); id++) {
+        if (std::any_of(subsets.begin(id), subsets.end(id), [&n](const FAState s) { return n.isAcceptState(s); })) {
+            acceptStates.insert(id);
         }
-        transition.emplace_back(tempMap);
-        tempMap.clear();
     }
 
     states = (FAState)transition.size();
-
-    simplify();
 }
 
 void DFA::receive(const FASymbol symbol)
@@ -155,7 +189,7 @@ bool DFA::recognize(const string& str)
 {
     resetCurrentState();
     for (auto it = str.begin(); it != str.end(); it++) {
-        receive(*it);
+        receive((unsigned char)*it);
     }
     return isAcceptState(currentState);
 }
@@ -183,20 +217,32 @@ vector<Substring> DFA::findRecognizedSubstrings(const string& str)
         matchedSubstring.second = 0;
     }
 
+    // Restarts are skipped by `prefilter` to where a match can begin, see `Prefilter::skip`.
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(str.data());
+    const unsigned char *nextCheck = data;
+    auto skip = [&]() {
+        if (prefilter.isActive() && data + (parser - str.begin()) >= nextCheck) {
+            parser = str.begin() + (prefilter.skip(data + (parser - str.begin()), data + str.size(), nextCheck) - data);
+        }
+    };
+    skip();
+    matchedSubstring.first = parser;
+
     while (parser < str.end()) {
 
-        receive(*parser);
+        receive((unsigned char)*parser);
 
-        if (isTerminalState(currentState)) {
+        if (currentState == StateNotFound || isTerminalState(currentState)) {
 
             if (matchedSubstring.second != NothingMatched) {
                 result.push_back({(FAState)(matchedSubstring.first - str.begin()), matchedSubstring.second});
             }
-            if (currentState == beginState) {
+            if (beginFromStartStates) {
                 parser++;
             }
             beginFromStartStates = true;
             currentState = beginState;
+            skip();
             matchedSubstring = {parser, NothingMatched};
 
         } else {
@@ -218,6 +264,7 @@ vector<Substring> DFA::findRecognizedSubstrings(const string& str)
 
 void DFA::makeUnion(const DFA& d)
 {
+    ScratchArena scratch;
     NFA n1 = NFA(*this);
     NFA n2 = NFA(d);
     n1.makeUnion(n2);
@@ -228,6 +275,7 @@ void DFA::makeUnion(const DFA& d)
 
 void DFA::makeConcatenation(const DFA& d)
 {
+    ScratchArena scratch;
     NFA n1 = NFA(*this);
     NFA n2 = NFA(d);
     n1.makeConcatenation(n2);
@@ -238,6 +286,7 @@ void DFA::makeConcatenation(const DFA& d)
 
 void DFA::makeStar(void)
 {
+    ScratchArena scratch;
     NFA n1 = NFA(*this);
     n1.makeStar();
     DFA d2 = DFA(n1);
@@ -246,6 +295,38 @@ void DFA::makeStar(void)
 }
 
 void DFA::simplify(void)
+{
+    ArenaVector<FAState> groups(states);
+    for (FAState s = 0; s < states; s++) {
+        groups[s] = isAcceptState(s) ? 1 : 0;
+    }
+
+    const FASymbol classCount = byteClasses.classCount();
+    const FAState groupCount = minimizeStates(transition, classCount, groups);
+
+    ArenaVector<ArenaVector<FAState>> tempTransition(groupCount, ArenaVector<FAState>(classCount));
+    unordered_set<FAState> tempAcceptStates;
+
+    for (FAState i = 0; i < states; i++) {
+
+        if (isAcceptState(i)) {
+            tempAcceptStates.insert(groups[i]);
+        }
+        for (FASymbol c = 0; c < classCount; c++) {
+            tempTransition[groups[i]][c] = groups[transition[i][c]];
+        }
+    }
+
+    states = groupCount;
+    startState = groups[startState];
+    acceptStates = tempAcceptStates;
+    transition = std::move(tempTransition);
+
+    calculateTerminalStates();
+    calculatePrefilter();
+}
+
+void DFA::simplifyByMoore(void)
 {
     vector<StateGroupInfo> groups = vector<StateGroupInfo>(states, StateGroupInfo{0, 0});
     FAState acceptStatesGroupNum = acceptStates.size() == states ? 0 : 1;
@@ -258,39 +339,36 @@ void DFA::simplify(void)
     unordered_map<StateGroupInfo, FAState> newStateGroupMap;
     FAState resState;
     FAState currentStateCount = acceptStatesGroupNum + 1;
-    FASymbol symbol;
+    const FASymbol classCount = byteClasses.classCount();
 
-    int i = 0;
-    while (i < symbols.size()) {
+    FASymbol c = 0;
+    while (c < classCount) {
 
-        for (symbol = symbols[i].first; symbol <= symbols[i].second; symbol++) {
+        newStateGroupMap.clear();
 
-            newStateGroupMap.clear();
+        for (FAState j = 0; j < states; j++) {
 
-            for (int j = 0; j < states; j++) {
-
-                resState = transition[j][symbol];
-                groups[j].resultGroupNum = groups[resState].groupNum;
-                if (newStateGroupMap.find(groups[j]) == newStateGroupMap.end()) {
-                    newStateGroupMap[groups[j]] = (FAState)newStateGroupMap.size();
-                }
+            resState = transition[j][c];
+            groups[j].resultGroupNum = groups[resState].groupNum;
+            if (newStateGroupMap.find(groups[j]) == newStateGroupMap.end()) {
+                newStateGroupMap[groups[j]] = (FAState)newStateGroupMap.size();
             }
+        }
 
-            if (newStateGroupMap.size() > currentStateCount) {
-
-                for (int j = 0; j < states; j++) {
-                    groups[j].groupNum = newStateGroupMap[groups[j]];
-                }
-                currentStateCount = (FAState)newStateGroupMap.size();
+        if (newStateGroupMap.size() > currentStateCount) {
 
-                i = -1;
-                break;
+            for (FAState j = 0; j < states; j++) {
+                groups[j].groupNum = newStateGroupMap[groups[j]];
             }
+            currentStateCount = (FAState)newStateGroupMap.size();
+
+            c = 0;
+            continue;
         }
-        i++;
+        c++;
     }
 
-    unordered_map<FAState, unordered_map<FASymbol, FAState>> tempTransition;
+    ArenaVector<ArenaVector<FAState>> tempTransition(currentStateCount, ArenaVector<FAState>(classCount));
     unordered_set<FAState> tempAcceptStates;
 
     for (FAState i = 0; i < states; i++) {
@@ -298,23 +376,18 @@ void DFA::simplify(void)
         if (isAcceptState(i)) {
             tempAcceptStates.insert(groups[i].groupNum);
         }
-        for (FASymbol j = 0; j < symbols.size(); j++) {
-            for (FASymbol symbol = symbols[j].first; symbol <= symbols[j].second; symbol++) {
-                tempTransition[groups[i].groupNum][symbol] = groups[transition[i][symbol]].groupNum;
-            }
+        for (c = 0; c < classCount; c++) {
+            tempTransition[groups[i].groupNum][c] = groups[transition[i][c]].groupNum;
         }
     }
 
     states = currentStateCount;
     startState = groups[startState].groupNum;
     acceptStates = tempAcceptStates;
-
-    transition.clear();
-    for (int i = 0; i < currentStateCount; i++) {
-        transition.emplace_back(tempTransition[i]);
-    }
+    transition = std::move(tempTransition);
 
     calculateTerminalStates();
+    calculatePrefilter();
 }
 
 void DFA::resetCurrentState(void)
@@ -10,31 +10,49 @@
 
 #include "HashValue.h"
 #include "FA.hpp"
+#include "ConstructionArena.hpp"
+#include "ByteClasses.hpp"
+#include "Prefilter.hpp"
 
 namespace FAS
 {
 
 class NFA;
+class DenseDFA;
 
 class DFA: public FA
 {
 private:
 
     friend class NFA;
+    friend class DenseDFA;
 
     FAState currentState;
-    vector<unordered_map<FASymbol, FAState>> transition;
-    unordered_set<FAState> terminalStates = {}; // for any t in `terminalStates` and all s in `symbols`, `transition`[t][s] == t and t not in `acceptStates`.
+    ByteClasses byteClasses; // Transitions are stored for classes of symbols rather than each symbol.
+    ArenaVector<ArenaVector<FAState>> transition; // `transition`[s][c] is the next state of s receiving any symbol of class c.
+    unordered_set<FAState> terminalStates = {}; // for any t in `terminalStates` and all classes c, `transition`[t][c] == t and t not in `acceptStates`.
+    RequiredLiteral requiredLiteral; // Known from the regex of the NFA, or found from the automaton by `calculatePrefilter`.
+    Prefilter prefilter;
 
     void resetCurrentState(void);
 
+    // Group symbols of `symbolTransition` into classes and store transitions of classes, a dead state is added if some symbol has no transition.
+    void compressTransition(const vector<unordered_map<FASymbol, FAState>>& symbolTransition);
+
 protected:
 
     FAState transitResult(const FAState state, const FASymbol symbol) const;
     bool isTerminalState(const FAState state) const;
     void calculateTerminalStates(void);
+    // Find bytes killing every live state, and if no literal is known, a prefix spelled by the only live path from `startState`. Call it after `calculateTerminalStates`.
+    void calculatePrefilter(void);
 
+    // Become the subset construction of `n`, without merging equivalent states. `DFA(const NFA&&)` is this followed by `simplify`.
+    void determinize(const NFA& n);
+    // Merge equivalent states with Hopcroft's algorithm, see `minimizeStates`.
     void simplify(void) override;
+    // The former Moore-style refinement, which rescans every class and state whenever a group splits. It is only kept to check `simplify` against.
+    void simplifyByMoore(void);
 
 public:
 
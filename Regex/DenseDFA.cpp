@@ -0,0 +1,578 @@
+//
+//  DenseDFA.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "DenseDFA.hpp"
+#include "DFA.hpp"
+
+using namespace FAS;
+
+namespace
+{
+
+const char FormatMagic[8] = {'F', 'A', 'S', 'D', 'e', 'n', 's', 'e'};
+const size_t HeaderSize = 584; // Up to the symbol ranges, see `DenseDFA::save`.
+const bool LittleEndian = std::endian::native == std::endian::little;
+
+void putInteger(string& out, const uint64_t value, const unsigned int width)
+{
+    for (unsigned int i = 0; i < width; i++) {
+        out.push_back((char)(value >> (8 * i)));
+    }
+}
+
+uint64_t getInteger(const unsigned char *in, const unsigned int width)
+{
+    uint64_t value = 0;
+    for (unsigned int i = 0; i < width; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+[[noreturn]] void failLoading(const string& path, const string& reason)
+{
+    throw std::runtime_error(path + ": " + reason);
+}
+
+size_t alignedTo8(const size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+}
+
+DenseDFA::DenseDFA(): FA(1, {}, DeadState, {}), currentState(DeadState), firstAcceptState(1), byteClasses(), alphabetSize(1), stateWidth(1)
+{
+    unsigned char *data = allocateStorage();
+    data[0] = DeadState;
+    reinterpret_cast<Acceleration *>(data + alphabetSize * stateWidth)[0] = Acceleration();
+}
+
+DenseDFA::DenseDFA(const DFA& d): FA(1, d.symbols, DeadState, {}), currentState(DeadState), firstAcceptState(1), byteClasses(d.byteClasses), alphabetSize(d.byteClasses.classCount()), stateWidth(1), requiredLiteral(d.requiredLiteral)
+{
+    // Give every state of `d` a new number, terminal states are all merged into `DeadState`, and accept states are put at last.
+    vector<FAState> newStatesMap(d.states, DeadState);
+    FAState index = 1;
+    for (FAState s = 0; s < d.states; s++) {
+        if (!d.isTerminalState(s) && !d.isAcceptState(s)) {
+            newStatesMap[s] = index++;
+        }
+    }
+    firstAcceptState = index;
+    for (FAState s = 0; s < d.states; s++) {
+        if (d.isAcceptState(s)) {
+            newStatesMap[s] = index++;
+        }
+    }
+
+    states = index;
+    if (d.states > 0) {
+        startState = newStatesMap[d.startState];
+    }
+    currentState = startState;
+
+    vector<FAState> newTransition((size_t)states * alphabetSize, DeadState);
+    for (FAState s = 0; s < d.states; s++) {
+        if (d.isTerminalState(s)) { continue; }
+        for (FASymbol c = 0; c < alphabetSize; c++) {
+            newTransition[(size_t)newStatesMap[s] * alphabetSize + c] = newStatesMap[d.transition[s][c]];
+        }
+    }
+
+    stateWidth = states <= UINT8_MAX + 1 ? 1 : (states <= UINT16_MAX + 1 ? 2 : 4);
+    unsigned char *data = allocateStorage();
+    switch (stateWidth) {
+        case 1: fillTable<uint8_t>(newTransition, data); break;
+        case 2: fillTable<uint16_t>(newTransition, data); break;
+        default: fillTable<uint32_t>(newTransition, data); break;
+    }
+
+    // A byte kills every live state if its class leads all of them to `DeadState`.
+    ByteFlags killers{};
+    for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+        const FASymbol c = byteClasses.classOf(symbol);
+        bool kills = true;
+        for (FAState s = DeadState + 1; s < states && kills; s++) {
+            kills = newTransition[(size_t)s * alphabetSize + c] == DeadState;
+        }
+        killers[symbol] = kills;
+    }
+    prefilter = Prefilter(requiredLiteral, killers);
+
+    Acceleration *newAccelerations = reinterpret_cast<Acceleration *>(data + newTransition.size() * stateWidth);
+    newAccelerations[DeadState] = Acceleration();
+    for (FAState s = DeadState + 1; s < states; s++) {
+        Acceleration a;
+        a.count = 0;
+        for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount && a.count != NotAccelerated; symbol++) {
+            if (newTransition[(size_t)s * alphabetSize + byteClasses.classOf(symbol)] != s) {
+                if (a.count < MaxEscapes) {
+                    a.escapes[a.count++] = (unsigned char)symbol;
+                } else {
+                    a.count = NotAccelerated;
+                }
+            }
+        }
+        newAccelerations[s] = a;
+    }
+}
+
+unsigned char *DenseDFA::allocateStorage(void)
+{
+    const size_t tableSize = (size_t)states * alphabetSize * stateWidth;
+    auto buffer = std::make_shared<vector<unsigned char>>(tableSize + (size_t)states * sizeof(Acceleration));
+    unsigned char *data = buffer->data();
+    table = data;
+    accelerations = reinterpret_cast<const Acceleration *>(data + tableSize);
+    storage = buffer;
+    return data;
+}
+
+template <typename T>
+void DenseDFA::fillTable(const vector<FAState>& newTransition, unsigned char *rows)
+{
+    for (size_t i = 0; i < newTransition.size(); i++) {
+        reinterpret_cast<T *>(rows)[i] = (T)newTransition[i];
+    }
+}
+
+template <typename T>
+bool DenseDFA::recognize(const T *rows, const unsigned char *parser, const unsigned char *end) const
+{
+    FAState state = startState;
+
+    // Accelerations are checked only when a state is entered, so self-loops of other states cost nothing.
+    parser = skipLoops(state, parser, end);
+    while (parser < end && state != DeadState) {
+        const FAState next = rows[(size_t)state * alphabetSize + byteClasses.classOf(*parser++)];
+        if (next != state) {
+            state = next;
+            parser = skipLoops(state, parser, end);
+        }
+    }
+    return state >= firstAcceptState;
+}
+
+DenseDFA::Search DenseDFA::startSearch(const std::string_view text) const
+{
+    Search search;
+    search.begin = reinterpret_cast<const unsigned char *>(text.data());
+    search.end = search.begin + text.size();
+    search.finished = startState == DeadState;
+    search.state = startState;
+    search.beginFromStartState = false;
+
+    // `matchBegin` with `matchedLength` stores substring that is being analysed.
+    search.parser = search.matchBegin = search.nextCheck = search.begin;
+    search.matchedLength = startState >= firstAcceptState ? 0 : NothingMatched;
+
+    if (search.finished) { return search; }
+
+    // Restarts are skipped by `prefilter` to where a match can begin, see `Prefilter::skip`.
+    if (prefilter.isActive()) {
+        search.parser = search.matchBegin = prefilter.skip(search.begin, search.end, search.nextCheck);
+    }
+
+    // Self-loops of the start state are skipped like in `resume`.
+    const unsigned char *stop = skipLoops(startState, search.parser, search.end);
+    if (stop != search.parser) {
+        search.parser = stop;
+        if (startState >= firstAcceptState) {
+            search.matchedLength = (unsigned int)(search.parser - search.matchBegin);
+        }
+    }
+    return search;
+}
+
+template <typename T, typename OnMatch>
+void DenseDFA::resume(const T *rows, Search& search, OnMatch onMatch) const
+{
+    if (search.finished) { return; }
+
+    // The search is kept in locals while scanning, and written back when it stops.
+    const unsigned char *const begin = search.begin;
+    const unsigned char *const end = search.end;
+    const unsigned char *matchBegin = search.matchBegin;
+    unsigned int matchedLength = search.matchedLength;
+    FAState state = search.state;
+    bool beginFromStartState = search.beginFromStartState;
+    const unsigned char *nextCheck = search.nextCheck;
+
+    // Follow the symbol under analysed.
+    const unsigned char *parser = search.parser;
+
+    // When a state is entered, its self-loops are skipped as if received one by one. They are never checked for the same state again, so self-loops of other states cost nothing.
+    auto accelerate = [&]() {
+        const unsigned char *stop = skipLoops(state, parser, end);
+        if (stop != parser) {
+            parser = stop;
+            beginFromStartState = false;
+            if (state >= firstAcceptState) {
+                matchedLength = (unsigned int)(parser - matchBegin);
+            }
+        }
+    };
+
+    while (parser < end) {
+
+        const FAState next = rows[(size_t)state * alphabetSize + byteClasses.classOf(*parser)];
+
+        if (next == DeadState) {
+
+            const Substring match = {(unsigned int)(matchBegin - begin), matchedLength};
+            if (beginFromStartState) {
+                parser++;
+            }
+            beginFromStartState = true;
+            state = startState;
+            if (parser >= nextCheck && prefilter.isActive()) {
+                parser = prefilter.skip(parser, end, nextCheck);
+            }
+            matchBegin = parser;
+            matchedLength = NothingMatched;
+            accelerate();
+
+            // The restart is done before the match is given, so the search can stop here and go on later.
+            if (match.second != NothingMatched && !onMatch(match)) {
+                search = {begin, end, parser, matchBegin, matchedLength, nextCheck, state, beginFromStartState, false};
+                return;
+            }
+
+        } else {
+
+            beginFromStartState = false;
+            parser++;
+            if (next >= firstAcceptState) {
+                matchedLength = (unsigned int)(parser - matchBegin);
+            }
+            if (next != state) {
+                state = next;
+                accelerate();
+            }
+        }
+    }
+
+    search.finished = true;
+    if (matchedLength != NothingMatched) {
+        onMatch({(unsigned int)(matchBegin - begin), matchedLength});
+    }
+}
+
+template <typename OnMatch>
+void DenseDFA::resume(Search& search, OnMatch onMatch) const
+{
+    switch (stateWidth) {
+        case 1: resume(reinterpret_cast<const uint8_t *>(table), search, onMatch); break;
+        case 2: resume(reinterpret_cast<const uint16_t *>(table), search, onMatch); break;
+        default: resume(reinterpret_cast<const uint32_t *>(table), search, onMatch); break;
+    }
+}
+
+void DenseDFA::receive(const FASymbol symbol)
+{
+    if (symbol >= ByteClasses::SymbolCount) {
+        currentState = DeadState;
+        return;
+    }
+    size_t index = (size_t)currentState * alphabetSize + byteClasses.classOf(symbol);
+    switch (stateWidth) {
+        case 1: currentState = reinterpret_cast<const uint8_t *>(table)[index]; break;
+        case 2: currentState = reinterpret_cast<const uint16_t *>(table)[index]; break;
+        default: currentState = reinterpret_cast<const uint32_t *>(table)[index]; break;
+    }
+}
+
+bool DenseDFA::recognize(const string& str)
+{
+    resetCurrentState();
+    return recognize(str.data(), str.size());
+}
+
+bool DenseDFA::recognize(const char *data, const size_t size) const
+{
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(data);
+    switch (stateWidth) {
+        case 1: return recognize(reinterpret_cast<const uint8_t *>(table), begin, begin + size);
+        case 2: return recognize(reinterpret_cast<const uint16_t *>(table), begin, begin + size);
+        default: return recognize(reinterpret_cast<const uint32_t *>(table), begin, begin + size);
+    }
+}
+
+vector<Substring> DenseDFA::findRecognizedSubstrings(const string& str)
+{
+    resetCurrentState();
+    return findRecognizedSubstrings(str.data(), str.size());
+}
+
+vector<Substring> DenseDFA::findRecognizedSubstrings(const char *data, const size_t size) const
+{
+    return findRecognizedSubstrings(std::string_view(data, size));
+}
+
+bool DenseDFA::recognize(const std::string_view text) const
+{
+    return recognize(text.data(), text.size());
+}
+
+vector<Substring> DenseDFA::findRecognizedSubstrings(const std::string_view text) const
+{
+    // `result` stores all matched substring.
+    vector<Substring> result;
+    Search search = startSearch(text);
+    resume(search, [&](const Substring& match) {
+        result.push_back(match);
+        return true;
+    });
+    return result;
+}
+
+DenseDFA::MatchIterator::MatchIterator(const DenseDFA& dfa, const std::string_view text): dfa(&dfa), search(dfa.startSearch(text)), atEnd(false)
+{
+    ++*this;
+}
+
+DenseDFA::MatchIterator& DenseDFA::MatchIterator::operator++()
+{
+    atEnd = true;
+    dfa->resume(search, [&](const Substring& m) {
+        match = m;
+        atEnd = false;
+        return false;
+    });
+    return *this;
+}
+
+DenseDFA::MatchRange DenseDFA::matches(const std::string_view text) const
+{
+    return MatchRange(MatchIterator(*this, text));
+}
+
+size_t DenseDFA::count(const std::string_view text) const
+{
+    size_t count = 0;
+    Search search = startSearch(text);
+    resume(search, [&](const Substring&) {
+        count++;
+        return true;
+    });
+    return count;
+}
+
+std::optional<Substring> DenseDFA::first(const std::string_view text) const
+{
+    std::optional<Substring> result;
+    Search search = startSearch(text);
+    resume(search, [&](const Substring& match) {
+        result = match;
+        return false;
+    });
+    return result;
+}
+
+size_t DenseDFA::memoryUsage(void) const
+{
+    const size_t storageUsage = (size_t)states * (alphabetSize * stateWidth + sizeof(Acceleration));
+    return sizeof(DenseDFA) + storageUsage + symbols.capacity() * sizeof(symbols[0]) + requiredLiteral.literal.capacity() * 2;
+}
+
+void DenseDFA::save(std::ostream& out) const
+{
+    const size_t tableSize = (size_t)states * alphabetSize * stateWidth;
+    const size_t tableOffset = alignedTo8(HeaderSize + symbols.size() * 8 + requiredLiteral.literal.size());
+    const size_t accelerationsOffset = alignedTo8(tableOffset + tableSize);
+    const size_t fileSize = accelerationsOffset + (size_t)states * sizeof(Acceleration);
+
+    string header(FormatMagic, sizeof(FormatMagic));
+    putInteger(header, FormatVersion, 4);
+    for (uint32_t value : {states, startState, firstAcceptState, alphabetSize, stateWidth, (uint32_t)symbols.size(), (uint32_t)requiredLiteral.literal.size(), (uint32_t)requiredLiteral.isPrefix, 0u}) {
+        putInteger(header, value, 4);
+    }
+    for (uint64_t value : {tableOffset, accelerationsOffset, fileSize}) {
+        putInteger(header, value, 8);
+    }
+    for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+        header.push_back((char)byteClasses.classOf(symbol));
+    }
+    for (bool kills : prefilter.killerBytes()) {
+        header.push_back(kills ? 1 : 0);
+    }
+    for (const auto& range : symbols) {
+        putInteger(header, range.first, 4);
+        putInteger(header, range.second, 4);
+    }
+    header += requiredLiteral.literal;
+    header.resize(tableOffset, 0);
+    out.write(header.data(), header.size());
+
+    if (LittleEndian || stateWidth == 1) {
+        out.write(reinterpret_cast<const char *>(table), tableSize);
+    } else {
+        string converted;
+        converted.reserve(tableSize);
+        for (size_t i = 0; i < tableSize / stateWidth; i++) {
+            putInteger(converted, stateWidth == 2 ? reinterpret_cast<const uint16_t *>(table)[i] : reinterpret_cast<const uint32_t *>(table)[i], stateWidth);
+        }
+        out.write(converted.data(), converted.size());
+    }
+    const string padding(accelerationsOffset - tableOffset - tableSize, 0);
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char *>(accelerations), (size_t)states * sizeof(Acceleration));
+
+    if (!out) {
+        throw std::runtime_error("failed to write the automaton");
+    }
+}
+
+void DenseDFA::save(const string& path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("can not open " + path);
+    }
+    save(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+DenseDFA DenseDFA::load(const string& path, const LoadCheck check)
+{
+    int descriptor = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (descriptor < 0 || fstat(descriptor, &info) != 0) {
+        const int error = errno;
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        failLoading(path, strerror(error));
+    }
+    const size_t size = (size_t)info.st_size;
+    if (size < HeaderSize) {
+        close(descriptor);
+        failLoading(path, "not a compiled automaton");
+    }
+    void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED) {
+        failLoading(path, strerror(errno));
+    }
+    // Unmapped when the last copy of the automaton is gone.
+    std::shared_ptr<const void> mapping(address, [size](const void *a) { munmap(const_cast<void *>(a), size); });
+    const unsigned char *data = static_cast<const unsigned char *>(address);
+
+    if (memcmp(data, FormatMagic, sizeof(FormatMagic)) != 0) {
+        failLoading(path, "not a compiled automaton");
+    }
+    if (getInteger(data + 8, 4) != FormatVersion) {
+        failLoading(path, "unsupported format version " + std::to_string(getInteger(data + 8, 4)));
+    }
+
+    DenseDFA result;
+    result.states = (FAState)getInteger(data + 12, 4);
+    result.startState = (FAState)getInteger(data + 16, 4);
+    result.firstAcceptState = (FAState)getInteger(data + 20, 4);
+    result.alphabetSize = (unsigned int)getInteger(data + 24, 4);
+    result.stateWidth = (unsigned int)getInteger(data + 28, 4);
+    const uint64_t rangeCount = getInteger(data + 32, 4);
+    const uint64_t literalLength = getInteger(data + 36, 4);
+    const bool isPrefix = getInteger(data + 40, 4) != 0;
+    const uint64_t tableOffset = getInteger(data + 48, 8);
+    const uint64_t accelerationsOffset = getInteger(data + 56, 8);
+    const uint64_t tableSize = (uint64_t)result.states * result.alphabetSize * result.stateWidth;
+    const uint64_t accelerationsSize = (uint64_t)result.states * sizeof(Acceleration);
+
+    if (getInteger(data + 64, 8) != size) {
+        failLoading(path, "truncated");
+    }
+    if (result.states == 0 || result.startState >= result.states || result.firstAcceptState == DeadState || result.firstAcceptState > result.states) {
+        failLoading(path, "invalid states");
+    }
+    if (result.alphabetSize == 0 || result.alphabetSize > ByteClasses::SymbolCount) {
+        failLoading(path, "invalid alphabet size");
+    }
+    if ((result.stateWidth != 1 && result.stateWidth != 2 && result.stateWidth != 4) || (result.stateWidth < 4 && result.states > (1ull << (8 * result.stateWidth)))) {
+        failLoading(path, "invalid state width");
+    }
+    if (HeaderSize + rangeCount * 8 + literalLength > tableOffset || tableOffset % 8 != 0 || tableOffset + tableSize > accelerationsOffset || accelerationsOffset % 8 != 0 || accelerationsOffset + accelerationsSize > size) {
+        failLoading(path, "invalid layout");
+    }
+
+    std::array<unsigned char, ByteClasses::SymbolCount> classes;
+    ByteFlags killers;
+    for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+        classes[symbol] = data[72 + symbol];
+        killers[symbol] = data[72 + ByteClasses::SymbolCount + symbol] != 0;
+    }
+    try {
+        result.byteClasses = ByteClasses(classes);
+    } catch (const std::invalid_argument& e) {
+        failLoading(path, e.what());
+    }
+    if (result.byteClasses.classCount() != result.alphabetSize) {
+        failLoading(path, "byte classes do not match the alphabet size");
+    }
+
+    result.symbols.clear();
+    for (uint64_t i = 0; i < rangeCount; i++) {
+        result.symbols.push_back({(FASymbol)getInteger(data + HeaderSize + i * 8, 4), (FASymbol)getInteger(data + HeaderSize + i * 8 + 4, 4)});
+    }
+    result.requiredLiteral = {string(reinterpret_cast<const char *>(data + HeaderSize + rangeCount * 8), literalLength), isPrefix};
+    result.prefilter = Prefilter(result.requiredLiteral, killers);
+    result.currentState = result.startState;
+
+    const Acceleration *accelerations = reinterpret_cast<const Acceleration *>(data + accelerationsOffset);
+    if (check == Verify) {
+        // Escapes are read by index, so their counts are checked.
+        for (FAState s = 0; s < result.states; s++) {
+            if (accelerations[s].count > MaxEscapes && accelerations[s].count != NotAccelerated) {
+                failLoading(path, "invalid accelerations");
+            }
+        }
+        // So are the states of the table, once here instead of on every transition of a scan.
+        for (uint64_t i = 0; i < tableSize / result.stateWidth; i++) {
+            if (getInteger(data + tableOffset + i * result.stateWidth, result.stateWidth) >= result.states) {
+                failLoading(path, "invalid transitions");
+            }
+        }
+    }
+
+    if (LittleEndian || result.stateWidth == 1) {
+        result.storage = mapping;
+        result.table = data + tableOffset;
+        result.accelerations = accelerations;
+    } else {
+        // The table is copied only on a big-endian machine.
+        unsigned char *copy = result.allocateStorage();
+        for (uint64_t i = 0; i < tableSize / result.stateWidth; i++) {
+            const uint64_t value = getInteger(data + tableOffset + i * result.stateWidth, result.stateWidth);
+            if (result.stateWidth == 2) {
+                reinterpret_cast<uint16_t *>(copy)[i] = (uint16_t)value;
+            } else {
+                reinterpret_cast<uint32_t *>(copy)[i] = (uint32_t)value;
+            }
+        }
+        memcpy(copy + tableSize, accelerations, accelerationsSize);
+    }
+    return result;
+}
+
+void DenseDFA::resetCurrentState(void)
+{
+    currentState = startState;
+}
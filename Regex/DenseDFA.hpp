@@ -0,0 +1,234 @@
+//
+//  DenseDFA.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef DenseDFA_hpp
+#define DenseDFA_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+#include "FA.hpp"
+#include "ByteClasses.hpp"
+#include "Prefilter.hpp"
+#include "ByteSearch.hpp"
+
+namespace FAS
+{
+
+class DFA;
+class StreamMatcher;
+class ParallelMatcher;
+class CodeGenerator;
+class LeftmostLongestMatcher;
+
+// An immutable copy of a `DFA` for matching only. All transitions live in one contiguous `states × alphabetSize` table of byte classes, so receiving a symbol is a class lookup and a single indexed load.
+// States are renumbered when compiling: 0 is the dead state, and accept states occupy the range [`firstAcceptState`, `states` - 1], so `acceptStates` is left empty.
+class DenseDFA: public FA
+{
+private:
+
+    static constexpr FAState DeadState = 0; // Every terminal state of the source DFA, and every symbol it can not receive, leads here.
+
+    FAState currentState;
+    FAState firstAcceptState;
+    ByteClasses byteClasses;
+    unsigned int alphabetSize; // One column for every byte class.
+    unsigned int stateWidth; // Bytes used by one state id in `table`, which is 1, 2 or 4 depending on the count of states.
+    RequiredLiteral requiredLiteral;
+    Prefilter prefilter;
+
+    static constexpr unsigned char NotAccelerated = 0xff;
+    static constexpr unsigned int MaxEscapes = 3;
+
+    // Like a terminal state loops on every symbol, an accelerated state loops on all but at most `MaxEscapes` bytes, so scanning skips to the next escape with `findAnyByte`.
+    struct Acceleration
+    {
+        unsigned char count = NotAccelerated; // Count of escape bytes, or `NotAccelerated`.
+        unsigned char escapes[MaxEscapes] = {};
+    };
+
+    // Owns `table` and `accelerations`, which are a buffer filled when compiling, or a file mapped by `load`. They never change, so copies share them.
+    std::shared_ptr<const void> storage;
+    const unsigned char *table; // table[state * alphabetSize + class] is the next state, stored with `stateWidth` bytes.
+    const Acceleration *accelerations; // One for each state.
+
+    // Where `state` leaves itself, if it is entered before `parser`.
+    inline const unsigned char *skipLoops(const FAState state, const unsigned char *parser, const unsigned char *end) const
+    {
+        const Acceleration& a = accelerations[state];
+        return a.count == NotAccelerated ? parser : findAnyByte(parser, end, a.escapes, a.count);
+    }
+
+    // Make a buffer for `table` and `accelerations` of `states` states, and return it for filling them.
+    unsigned char *allocateStorage(void);
+
+    template <typename T>
+    void fillTable(const vector<FAState>& newTransition, unsigned char *rows);
+
+    template <typename T>
+    bool recognize(const T *rows, const unsigned char *parser, const unsigned char *end) const;
+
+    static constexpr unsigned int NothingMatched = -1;
+
+    // Where a search of `findRecognizedSubstrings` is, so it can stop after a match and go on from there.
+    struct Search
+    {
+        const unsigned char *begin; // Positions of matches are from here.
+        const unsigned char *end;
+        const unsigned char *parser;
+        const unsigned char *matchBegin; // The substring that is being analysed,
+        unsigned int matchedLength; // and the length of its longest match so far, or `NothingMatched`.
+        const unsigned char *nextCheck; // See `Prefilter::skip`.
+        FAState state;
+        bool beginFromStartState;
+        bool finished;
+    };
+
+    Search startSearch(std::string_view text) const;
+
+    // Go on with `search` to the end of the text, calling `onMatch(match)` for every match. If it returns false, the search stops right after that match.
+    template <typename T, typename OnMatch>
+    void resume(const T *rows, Search& search, OnMatch onMatch) const;
+
+    // The same with the table of the width of this automaton.
+    template <typename OnMatch>
+    void resume(Search& search, OnMatch onMatch) const;
+
+    void resetCurrentState(void);
+
+public:
+
+    friend class StreamMatcher;
+    friend class ParallelMatcher;
+    friend class CodeGenerator;
+    friend class LeftmostLongestMatcher;
+
+    DenseDFA();
+    // Compile `d`, which is expected to be simplified already, into a dense table.
+    DenseDFA(const DFA& d);
+
+    // Before using this, make sure the `currentState` is what you need. Call `resetCurrentState` if you want to begin from `startState`.
+    void receive(const FASymbol symbol) override;
+    bool recognize(const string& str) override;
+    vector<Substring> findRecognizedSubstrings(const string& str) override;
+    // Same as above for `size` bytes at `data`, or the bytes of `text`, which are not copied. `currentState` is not used, so they may be called concurrently.
+    bool recognize(const char *data, const size_t size) const;
+    vector<Substring> findRecognizedSubstrings(const char *data, const size_t size) const;
+    bool recognize(std::string_view text) const;
+    vector<Substring> findRecognizedSubstrings(std::string_view text) const;
+
+    // Matches of `findRecognizedSubstrings`, found one by one as it is incremented, so iterating allocates nothing and the search stops where iterating does.
+    // The automaton and the text must outlive it. Copies go on separately.
+    class MatchIterator
+    {
+    private:
+
+        friend class DenseDFA;
+
+        const DenseDFA *dfa = nullptr;
+        Search search = {};
+        Substring match;
+        bool atEnd = true;
+
+        MatchIterator(const DenseDFA& dfa, std::string_view text);
+
+    public:
+
+        typedef std::input_iterator_tag iterator_concept;
+        typedef std::input_iterator_tag iterator_category;
+        typedef Substring value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Substring *pointer;
+        typedef const Substring& reference;
+
+        MatchIterator() = default;
+
+        const Substring& operator*() const { return match; }
+        const Substring *operator->() const { return &match; }
+        MatchIterator& operator++();
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return atEnd; }
+    };
+
+    // Matches of `text` for range-based for loops and `std::ranges`.
+    class MatchRange
+    {
+    private:
+
+        MatchIterator first;
+
+    public:
+
+        MatchRange(const MatchIterator& first): first(first) {}
+
+        MatchIterator begin(void) const { return first; }
+        std::default_sentinel_t end(void) const { return std::default_sentinel; }
+    };
+
+    MatchRange matches(std::string_view text) const;
+
+    // Call `onMatch(match)` for every match in order, without collecting them. If `onMatch` returns a bool, false stops the search after that match.
+    template <typename OnMatch>
+    void forEachMatch(std::string_view text, OnMatch&& onMatch) const
+    {
+        for (const Substring& match : matches(text)) {
+            if constexpr (std::is_same_v<std::invoke_result_t<OnMatch&, const Substring&>, bool>) {
+                if (!onMatch(match)) { return; }
+            } else {
+                onMatch(match);
+            }
+        }
+    }
+
+    // The count of matches, and the first one, which is known as soon as its attempt dies, so the rest of the text is not read.
+    size_t count(std::string_view text) const;
+    std::optional<Substring> first(std::string_view text) const;
+
+    // These hide those of `FA`, since accept states are a range rather than a set.
+    bool isAcceptState(const FAState state) const { return state >= firstAcceptState && state < states; }
+    bool containAcceptStates(const unordered_set<FAState>& states) const { return std::any_of(states.begin(), states.end(), [this](const FAState s) { return isAcceptState(s); }); }
+
+    // Bytes used by the automaton, for bounding caches of them.
+    size_t memoryUsage(void) const;
+
+    // Write the automaton in the binary format below, so it can be loaded without compiling it again. Throws `std::runtime_error` if writing fails.
+    void save(std::ostream& out) const;
+    void save(const string& path) const;
+    enum LoadCheck
+    {
+        Trusted, // Only the header and sizes are checked, so loading reads no page of the table, and the file must come from `save`.
+        Verify, // Every transition and acceleration is checked too, in one pass over the file, so scans of a damaged file never index out of the table.
+    };
+
+    // Map a file written by `save`, and match with its table where it is, so nothing is deserialized and processes share one copy of it in the page cache. Throws `std::runtime_error` if it can not be loaded.
+    static DenseDFA load(const string& path, const LoadCheck check = Trusted);
+
+    // The format is little-endian, with offsets from the beginning of the file:
+    //
+    //     0    magic "FASDense", then uint32 `FormatVersion`
+    //     12   uint32 states, startState, firstAcceptState, alphabetSize, stateWidth
+    //     32   uint32 count of symbol ranges, length of the required literal, 1 if it is a prefix, and 0
+    //     48   uint64 offset of the table, offset of accelerations, and size of the file
+    //     72   the byte class of every byte, then 1 for every killer byte of the prefilter and 0 for others
+    //     584  uint32 pairs of symbol ranges, then the required literal
+    //     the table, aligned to 8 bytes, with state ids of `stateWidth` bytes
+    //     accelerations, aligned to 8 bytes, 4 bytes for each state: the count of escapes, or 255, then 3 escape bytes
+    static constexpr uint32_t FormatVersion = 1;
+
+};
+
+}
+
+#endif /* DenseDFA_hpp */
@@ -8,6 +8,7 @@
 #ifndef FA_hpp
 #define FA_hpp
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -25,6 +26,7 @@ namespace FAS
 typedef unsigned int FAState;
 typedef unsigned int FASymbol;
 typedef pair<unsigned int, unsigned int> Substring; // pair.first means the position of string head, and pair.second means the length of string
+typedef pair<uint64_t, uint64_t> StreamSubstring; // Like `Substring`, but the position and length are offsets in a stream or a buffer, which may be longer than 4GB.
 
 const static FAState StateNotFound = -1;
 
@@ -0,0 +1,209 @@
+//
+//  LazyDFA.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+
+#include "LazyDFA.hpp"
+
+using namespace FAS;
+
+const FAState LazyDFA::UnknownState = -2;
+
+LazyDFA::LazyDFA(const NFA& n, const size_t memoryBudget): FA(0, n.symbols, BeginState, {}), nfa(n), byteClasses(n.calculateByteClasses()), representatives(byteClasses.representatives()), memoryBudget(memoryBudget), nextStates(n.states), currentState(BeginState)
+{
+    clearCache();
+}
+
+FAState LazyDFA::addState(vector<FAState>& stateSet)
+{
+    FAState state = (FAState)stateSets.size();
+    bool accept = std::any_of(stateSet.begin(), stateSet.end(), [this](FAState s) { return nfa.isAcceptState(s); });
+
+    memoryUsage += StateOverhead + sizeof(FAState) * (stateSet.size() + byteClasses.classCount());
+    if (!simulating) {
+        stateMap[BitNumber(stateSet)] = state;
+    }
+    stateSets.emplace_back(std::move(stateSet));
+    acceptFlags.push_back(accept);
+    transition.resize(transition.size() + byteClasses.classCount(), UnknownState);
+
+    if (accept) {
+        acceptStates.insert(state);
+    }
+    states = (FAState)stateSets.size();
+
+    return state;
+}
+
+FAState LazyDFA::determinize(const FAState state, const FASymbol classNum)
+{
+    vector<FAState> nextSet;
+    const FASymbol symbol = representatives[classNum];
+    if (nfa.isSymbolInRange(symbol)) {
+        nextStates.clear();
+        for (const auto& s : stateSets[state]) {
+            auto it = nfa.transition[s].find(symbol);
+            if (it == nfa.transition[s].end()) { continue; }
+            for (const auto& next : it->second) {
+                nfa.insertEmptySymbolReachableStates(nextStates, next);
+            }
+        }
+        nextSet.assign(nextStates.begin(), nextStates.end());
+        std::sort(nextSet.begin(), nextSet.end());
+    }
+
+    if (!simulating) {
+
+        BitNumber stateNumber(nextSet);
+        auto it = stateMap.find(stateNumber);
+        if (it != stateMap.end()) {
+            transition[(size_t)state * byteClasses.classCount() + classNum] = it->second;
+            return it->second;
+        }
+
+        if (memoryUsage + StateOverhead + sizeof(FAState) * (nextSet.size() + byteClasses.classCount()) > memoryBudget) {
+            // `state` is gone after flushing, so its transition can not be recorded.
+            flush();
+            if (!simulating) {
+                it = stateMap.find(stateNumber);
+                return it != stateMap.end() ? it->second : addState(nextSet);
+            }
+        } else {
+            FAState next = addState(nextSet);
+            transition[(size_t)state * byteClasses.classCount() + classNum] = next;
+            return next;
+        }
+    }
+
+    // Simulate the NFA with 2 scratch states used in turn, and never record transitions to them.
+    if (nextSet.empty()) {
+        return DeadState;
+    }
+    const FAState scratch = state == BeginState + 1 ? BeginState + 2 : BeginState + 1;
+    acceptFlags[scratch] = std::any_of(nextSet.begin(), nextSet.end(), [this](FAState s) { return nfa.isAcceptState(s); });
+    stateSets[scratch] = std::move(nextSet);
+    return scratch;
+}
+
+void LazyDFA::flush(void)
+{
+    flushes++;
+    if (receivedSymbols < MinimumSymbolsPerState * stateSets.size()) {
+        simulating = true;
+    }
+    clearCache();
+}
+
+void LazyDFA::clearCache(void)
+{
+    receivedSymbols = 0;
+    memoryUsage = 0;
+    stateSets.clear();
+    acceptFlags.clear();
+    transition.clear();
+    stateMap.clear();
+    acceptStates.clear();
+
+    vector<FAState> stateSet;
+    addState(stateSet);
+    std::fill(transition.begin(), transition.end(), DeadState);
+
+    const unordered_set<FAState> beginStates = nfa.collectEmptySymbolReachableStates({nfa.startState});
+    stateSet.assign(beginStates.begin(), beginStates.end());
+    std::sort(stateSet.begin(), stateSet.end());
+    addState(stateSet);
+
+    if (simulating) {
+        for (int i = 0; i < 2; i++) {
+            stateSet.clear();
+            addState(stateSet);
+        }
+    }
+}
+
+void LazyDFA::receive(const FASymbol symbol)
+{
+    if (symbol >= ByteClasses::SymbolCount) {
+        currentState = DeadState;
+        return;
+    }
+    currentState = transitResult(currentState, byteClasses.classOf(symbol));
+}
+
+bool LazyDFA::recognize(const string& str)
+{
+    resetCurrentState();
+    for (auto it = str.begin(); it != str.end() && currentState != DeadState; it++) {
+        currentState = transitResult(currentState, byteClasses.classOf((unsigned char)*it));
+    }
+    return acceptFlags[currentState];
+}
+
+vector<Substring> LazyDFA::findRecognizedSubstrings(const string& str)
+{
+    resetCurrentState();
+
+    const unsigned int NothingMatched = -1;
+
+    // `pair.first` means the first location of matched substring in the string, and `pair.second` means the length.
+    // `result` stores all matched substring,
+    vector<Substring> result;
+    // and `matchedSubstring` stores substring that is being analysed.
+    pair<string::const_iterator, unsigned int> matchedSubstring{str.begin(), NothingMatched};
+
+    bool beginFromStartStates = false;
+
+    // Follow the symbol under analysed.
+    string::const_iterator parser = str.begin();
+
+    // To find out if the NFA accepts empty string.
+    if (acceptFlags[currentState]) {
+        matchedSubstring.second = 0;
+    }
+
+    while (parser < str.end()) {
+
+        currentState = transitResult(currentState, byteClasses.classOf((unsigned char)*parser));
+
+        if (currentState == DeadState) {
+
+            if (matchedSubstring.second != NothingMatched) {
+                result.push_back({(FAState)(matchedSubstring.first - str.begin()), matchedSubstring.second});
+            }
+            if (beginFromStartStates) {
+                parser++;
+            }
+            beginFromStartStates = true;
+            currentState = BeginState;
+            matchedSubstring = {parser, NothingMatched};
+
+        } else {
+
+            beginFromStartStates = false;
+            parser++;
+            if (acceptFlags[currentState]) {
+                matchedSubstring.second = (unsigned int)(parser - matchedSubstring.first);
+            }
+        }
+    }
+
+    if (matchedSubstring.second != NothingMatched) {
+        result.push_back({(FAState)(matchedSubstring.first - str.begin()), matchedSubstring.second});
+    }
+
+    return result;
+}
+
+void LazyDFA::resetCurrentState(void)
+{
+    // Falling back to simulation only lasts for one call.
+    if (simulating) {
+        simulating = false;
+        clearCache();
+    }
+    currentState = BeginState;
+}
@@ -0,0 +1,81 @@
+//
+//  LazyDFA.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef LazyDFA_hpp
+#define LazyDFA_hpp
+
+#include "NFA.hpp"
+#include "BitNumber.hpp"
+
+namespace FAS
+{
+
+// A DFA determinized on demand from an `NFA`: a state is only built when the input first reaches it, then cached in a table bounded by `memoryBudget`.
+// When the cache is full it is flushed, and if flushing happens too often for the input scanned, the rest of the call falls back to NFA simulation without caching.
+class LazyDFA: public FA
+{
+private:
+
+    static constexpr FAState DeadState = 0; // The empty set of NFA states, which is never flushed.
+    static constexpr FAState BeginState = 1; // The ε-closure of NFA's start state, which is never flushed.
+    static const FAState UnknownState; // A transition that has not been determinized yet.
+    static constexpr size_t StateOverhead = 64; // Memory taken by a cached state besides its NFA states and transitions, mostly `stateMap`.
+    static constexpr size_t MinimumSymbolsPerState = 10; // Fall back to NFA simulation if fewer symbols than this were received per cached state between flushes.
+
+    NFA nfa;
+    ByteClasses byteClasses;
+    vector<FASymbol> representatives;
+
+    vector<vector<FAState>> stateSets; // stateSets[s] is the sorted NFA states of s.
+    vector<bool> acceptFlags;
+    vector<FAState> transition; // transition[s * classCount + c] is the next state of s receiving class c, or `UnknownState`.
+    unordered_map<BitNumber, FAState> stateMap;
+
+    size_t memoryBudget;
+    size_t memoryUsage = 0;
+    size_t receivedSymbols = 0; // Symbols received since the last flush.
+    unsigned int flushes = 0;
+    bool simulating = false; // If true, states are not cached, and only 2 scratch states are used alternately.
+
+    SparseSet nextStates; // Scratch space for determinizing.
+
+    FAState currentState;
+
+    FAState addState(vector<FAState>& stateSet);
+    FAState determinize(const FAState state, const FASymbol classNum);
+    void flush(void);
+    void clearCache(void);
+
+    inline FAState transitResult(const FAState state, const FASymbol classNum)
+    {
+        receivedSymbols++;
+        FAState next = transition[(size_t)state * byteClasses.classCount() + classNum];
+        return next != UnknownState ? next : determinize(state, classNum);
+    }
+
+    void resetCurrentState(void);
+
+public:
+
+    static constexpr size_t DefaultMemoryBudget = 2 << 20;
+
+    LazyDFA(const NFA& n, const size_t memoryBudget = DefaultMemoryBudget);
+
+    // Before using this, make sure the `currentState` is what you need. Call `resetCurrentState` if you want to begin from `startState`.
+    void receive(const FASymbol symbol) override;
+    bool recognize(const string& str) override;
+    vector<Substring> findRecognizedSubstrings(const string& str) override;
+
+    size_t cachedStateCount(void) const { return stateSets.size(); }
+    unsigned int flushCount(void) const { return flushes; }
+    bool isSimulating(void) const { return simulating; }
+
+};
+
+}
+
+#endif /* LazyDFA_hpp */
@@ -0,0 +1,176 @@
+//
+//  LeftmostLongestMatcher.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+
+#include "LeftmostLongestMatcher.hpp"
+#include "SubsetArena.hpp"
+
+using namespace FAS;
+
+LeftmostLongestMatcher::LeftmostLongestMatcher(const DenseDFA& dfa): dfa(dfa), endState(0), stateWords((dfa.states + 63) / 64)
+{
+    const FAState states = dfa.states;
+    const unsigned int alphabetSize = dfa.alphabetSize;
+
+    auto next = [&](const FAState state, const unsigned int byteClass) -> FAState {
+        const size_t index = (size_t)state * alphabetSize + byteClass;
+        switch (dfa.stateWidth) {
+            case 1: return dfa.table[index];
+            case 2: return reinterpret_cast<const uint16_t *>(dfa.table)[index];
+            default: return reinterpret_cast<const uint32_t *>(dfa.table)[index];
+        }
+    };
+
+    // predecessors[predecessorBegin[c * states + t], predecessorBegin[c * states + t + 1]) are the states going to t on class c.
+    // Accept states are in every set anyway, and the dead state is in none, so only the others are listed.
+    vector<size_t> predecessorBegin((size_t)alphabetSize * states + 1, 0);
+    for (FAState s = DenseDFA::DeadState + 1; s < dfa.firstAcceptState; s++) {
+        for (unsigned int c = 0; c < alphabetSize; c++) {
+            predecessorBegin[(size_t)c * states + next(s, c) + 1]++;
+        }
+    }
+    for (size_t i = 1; i < predecessorBegin.size(); i++) {
+        predecessorBegin[i] += predecessorBegin[i - 1];
+    }
+    vector<FAState> predecessors(predecessorBegin.back());
+    vector<size_t> filled(predecessorBegin.begin(), predecessorBegin.end() - 1);
+    for (FAState s = DenseDFA::DeadState + 1; s < dfa.firstAcceptState; s++) {
+        for (unsigned int c = 0; c < alphabetSize; c++) {
+            predecessors[filled[(size_t)c * states + next(s, c)]++] = s;
+        }
+    }
+
+    // Subset construction over the reversed transitions, like `DFA(const NFA&&)`. A state has one successor on a class, so predecessors of different members never repeat.
+    SubsetArena subsets;
+    ArenaVector<FAState> subset;
+    auto intern = [&]() {
+        std::sort(subset.begin(), subset.end());
+        for (FAState s = dfa.firstAcceptState; s < states; s++) {
+            subset.push_back(s);
+        }
+        return subsets.intern(subset).first;
+    };
+
+    subset.clear();
+    endState = intern();
+    for (FAState id = 0; id < subsets.size(); id++) {
+        for (unsigned int c = 0; c < alphabetSize; c++) {
+            subset.clear();
+            for (auto t = subsets.begin(id); t != subsets.end(id); t++) {
+                const size_t row = (size_t)c * states + *t;
+                subset.insert(subset.end(), predecessors.begin() + predecessorBegin[row], predecessors.begin() + predecessorBegin[row + 1]);
+            }
+            reverseTransition.push_back(intern());
+        }
+    }
+
+    liveStates.assign((size_t)subsets.size() * stateWords, 0);
+    for (FAState id = 0; id < subsets.size(); id++) {
+        for (auto s = subsets.begin(id); s != subsets.end(id); s++) {
+            liveStates[(size_t)id * stateWords + *s / 64] |= (uint64_t)1 << (*s % 64);
+        }
+    }
+}
+
+template <typename T>
+vector<Substring> LeftmostLongestMatcher::findRecognizedSubstrings(const T *rows, const unsigned char *begin, const size_t size) const
+{
+    vector<Substring> result;
+    if (dfa.startState == DenseDFA::DeadState) { return result; }
+
+    // live(p) of every `BlockSize`-th position, from one pass from the end. Those of a block are computed again from the next checkpoint when the forward scan comes to it, which happens once, since the scan never goes back.
+    vector<FAState> checkpoints(size / BlockSize + 1);
+    FAState live = endState;
+    for (size_t p = size; p > 0; p--) {
+        if (p % BlockSize == 0) {
+            checkpoints[p / BlockSize] = live;
+        }
+        live = reverse(live, begin[p - 1]);
+    }
+
+    vector<FAState> block(BlockSize);
+    size_t blockBegin = 0;
+    auto loadBlock = [&](const size_t position) {
+        blockBegin = position - position % BlockSize;
+        // Going backwards from the next checkpoint, or from the end of the input.
+        size_t p = std::min(blockBegin + BlockSize, size);
+        FAState l = p == size ? endState : checkpoints[p / BlockSize];
+        if (p - blockBegin < BlockSize) {
+            block[p - blockBegin] = l;
+        }
+        while (p > blockBegin) {
+            l = reverse(l, begin[--p]);
+            block[p - blockBegin] = l;
+        }
+    };
+    auto liveAt = [&](const size_t position) {
+        if (position - blockBegin >= BlockSize) {
+            loadBlock(position);
+        }
+        return block[position - blockBegin];
+    };
+    loadBlock(0);
+
+    const FAState firstAcceptState = dfa.firstAcceptState;
+    auto next = [&](const FAState state, const unsigned char byte) -> FAState {
+        return rows[(size_t)state * dfa.alphabetSize + dfa.byteClasses.classOf(byte)];
+    };
+
+    bool emptyMatch = dfa.startState >= firstAcceptState;
+    size_t position = 0;
+    while (position < size) {
+
+        FAState state = next(dfa.startState, begin[position]);
+        if (!canAccept(liveAt(position + 1), state)) {
+            // No match of a byte or more begins here.
+            if (emptyMatch) {
+                result.push_back({0, 0});
+                emptyMatch = false;
+            }
+            position++;
+            continue;
+        }
+        emptyMatch = false;
+
+        // `state` is in live(position) all along, so if it is not an accept state, the next one is live too. The scan only stops in an accept state with nothing longer after it, which is the end of the longest match.
+        const size_t matchBegin = position++;
+        while (position < size) {
+            const FAState following = next(state, begin[position]);
+            if (!canAccept(liveAt(position + 1), following)) { break; }
+            state = following;
+            position++;
+        }
+        result.push_back({(unsigned int)matchBegin, (unsigned int)(position - matchBegin)});
+    }
+
+    if (emptyMatch) {
+        result.push_back({0, 0});
+    }
+
+    return result;
+}
+
+vector<Substring> LeftmostLongestMatcher::findRecognizedSubstrings(const char *data, const size_t size) const
+{
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(data);
+    switch (dfa.stateWidth) {
+        case 1: return findRecognizedSubstrings(reinterpret_cast<const uint8_t *>(dfa.table), begin, size);
+        case 2: return findRecognizedSubstrings(reinterpret_cast<const uint16_t *>(dfa.table), begin, size);
+        default: return findRecognizedSubstrings(reinterpret_cast<const uint32_t *>(dfa.table), begin, size);
+    }
+}
+
+vector<Substring> LeftmostLongestMatcher::findRecognizedSubstrings(const std::string_view str) const
+{
+    return findRecognizedSubstrings(str.data(), str.size());
+}
+
+size_t LeftmostLongestMatcher::memoryUsage(void) const
+{
+    return sizeof(LeftmostLongestMatcher) + reverseTransition.capacity() * sizeof(FAState) + liveStates.capacity() * sizeof(uint64_t);
+}
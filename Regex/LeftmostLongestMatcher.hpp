@@ -0,0 +1,65 @@
+//
+//  LeftmostLongestMatcher.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef LeftmostLongestMatcher_hpp
+#define LeftmostLongestMatcher_hpp
+
+#include <cstdint>
+
+#include "DenseDFA.hpp"
+
+namespace FAS
+{
+
+// Finds the leftmost-longest matches of a `DenseDFA` which do not overlap, reading every byte at most three times, so the work is linear in the input whatever the pattern is.
+// `findRecognizedSubstrings` of the automata restarts where an attempt died, which misses matches beginning inside a failed attempt, and scanning from every position instead is quadratic.
+// Here a reverse automaton first runs from the end of the input, so the forward scan knows at every position which states can still reach a match: it begins only where a match begins, and stops right at the end of the longest one.
+// As in `findRecognizedSubstrings`, the empty string is only matched at the beginning. `dfa` must outlive the matcher.
+class LeftmostLongestMatcher
+{
+private:
+
+    static constexpr size_t BlockSize = 4096; // Reverse states are kept for one block of positions at a time, and otherwise only at the beginning of every block.
+
+    const DenseDFA& dfa;
+
+    // States of the reverse automaton are the sets live(p) of forward states which reach an accept state reading a prefix of the input from p.
+    // live(size) is the accept states, and live(p) is them with the states going into live(p + 1) on the byte at p.
+    FAState endState; // live(size), of any input.
+    unsigned int stateWords; // 64-bit words of one set in `liveStates`.
+    vector<FAState> reverseTransition; // reverseTransition[live(p + 1) * alphabetSize + class] is live(p).
+    vector<uint64_t> liveStates; // Forward states of every reverse state, as bits.
+
+    FAState reverse(const FAState live, const unsigned char byte) const
+    {
+        return reverseTransition[(size_t)live * dfa.alphabetSize + dfa.byteClasses.classOf(byte)];
+    }
+
+    bool canAccept(const FAState live, const FAState state) const
+    {
+        return (liveStates[(size_t)live * stateWords + state / 64] >> (state % 64)) & 1;
+    }
+
+    template <typename T>
+    vector<Substring> findRecognizedSubstrings(const T *rows, const unsigned char *begin, const size_t size) const;
+
+public:
+
+    // Build the reverse automaton, which has a state for every set of forward states found live at some position, so like subset construction it may grow large for some patterns.
+    LeftmostLongestMatcher(const DenseDFA& dfa);
+
+    vector<Substring> findRecognizedSubstrings(const char *data, const size_t size) const;
+    vector<Substring> findRecognizedSubstrings(std::string_view str) const;
+
+    // Bytes used by the reverse automaton, not counting `dfa`.
+    size_t memoryUsage(void) const;
+
+};
+
+}
+
+#endif /* LeftmostLongestMatcher_hpp */
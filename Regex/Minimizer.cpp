@@ -0,0 +1,186 @@
+//
+//  Minimizer.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include "Minimizer.hpp"
+
+using namespace FAS;
+
+namespace
+{
+
+// States of a block are kept together in `elements`[first, end), and marked states are moved to the front of their block.
+struct Partition
+{
+    ArenaVector<FAState> elements;
+    ArenaVector<FAState> location; // location[s] is the index of s in `elements`.
+    ArenaVector<FAState> blockOf;
+    ArenaVector<FAState> first;
+    ArenaVector<FAState> end;
+    ArenaVector<FAState> marked; // marked[b] is the count of marked states at the front of block b.
+
+    FAState size(FAState b) const { return end[b] - first[b]; }
+
+    // Returns true if `b` has no marked state before.
+    bool mark(FAState s)
+    {
+        FAState b = blockOf[s];
+        FAState i = location[s];
+        FAState j = first[b] + marked[b];
+        if (i < j) { return false; }
+
+        FAState t = elements[j];
+        elements[i] = t;
+        location[t] = i;
+        elements[j] = s;
+        location[s] = j;
+        return marked[b]++ == 0;
+    }
+
+    // Move marked states of `b` into a new block and return it, or return `b` itself if all its states are marked.
+    FAState split(FAState b)
+    {
+        FAState m = marked[b];
+        marked[b] = 0;
+        if (m == size(b)) { return b; }
+
+        FAState n = (FAState)first.size();
+        first.push_back(first[b]);
+        end.push_back(first[b] + m);
+        marked.push_back(0);
+        first[b] += m;
+        for (FAState i = first[n]; i < end[n]; i++) {
+            blockOf[elements[i]] = n;
+        }
+        return n;
+    }
+};
+
+}
+
+FAState FAS::minimizeStates(const ArenaVector<ArenaVector<FAState>>& transition, const FASymbol classCount, ArenaVector<FAState>& groups)
+{
+    const FAState states = (FAState)transition.size();
+    if (states == 0) { return 0; }
+
+    // Only `groups` is kept.
+    ScratchArena scratch;
+
+    // Predecessors of state t by class c are predecessors[predecessorsBegin[t * classCount + c], predecessorsBegin[t * classCount + c + 1]).
+    ArenaVector<FAState> predecessorsBegin((size_t)states * classCount + 1, 0);
+    ArenaVector<FAState> predecessors((size_t)states * classCount);
+    for (FAState s = 0; s < states; s++) {
+        for (FASymbol c = 0; c < classCount; c++) {
+            predecessorsBegin[(size_t)transition[s][c] * classCount + c + 1]++;
+        }
+    }
+    for (size_t i = 1; i < predecessorsBegin.size(); i++) {
+        predecessorsBegin[i] += predecessorsBegin[i - 1];
+    }
+    ArenaVector<FAState> filled(predecessorsBegin.begin(), predecessorsBegin.end() - 1);
+    for (FAState s = 0; s < states; s++) {
+        for (FASymbol c = 0; c < classCount; c++) {
+            predecessors[filled[(size_t)transition[s][c] * classCount + c]++] = s;
+        }
+    }
+
+    // Init blocks with labels.
+    Partition p;
+    p.location.resize(states);
+    p.blockOf.resize(states);
+    ArenaMap<FAState, FAState> labelBlocks;
+    for (FAState s = 0; s < states; s++) {
+        auto it = labelBlocks.find(groups[s]);
+        if (it == labelBlocks.end()) {
+            it = labelBlocks.emplace(groups[s], (FAState)p.first.size()).first;
+            p.first.push_back(0);
+            p.end.push_back(0);
+            p.marked.push_back(0);
+        }
+        p.blockOf[s] = it->second;
+        p.end[it->second]++;
+    }
+    FAState begin = 0;
+    for (FAState b = 0; b < p.first.size(); b++) {
+        p.first[b] = begin;
+        begin += p.end[b];
+        p.end[b] = p.first[b];
+    }
+    p.elements.resize(states);
+    for (FAState s = 0; s < states; s++) {
+        FAState b = p.blockOf[s];
+        p.location[s] = p.end[b];
+        p.elements[p.end[b]++] = s;
+    }
+
+    // Every block but the largest one is a splitter at first.
+    ArenaVector<FAState> worklist;
+    ArenaVector<bool> inWorklist(p.first.size(), true);
+    FAState largest = 0;
+    for (FAState b = 1; b < p.first.size(); b++) {
+        if (p.size(b) > p.size(largest)) {
+            largest = b;
+        }
+    }
+    inWorklist[largest] = false;
+    for (FAState b = 0; b < p.first.size(); b++) {
+        if (inWorklist[b]) {
+            worklist.push_back(b);
+        }
+    }
+
+    ArenaVector<FAState> splitter;
+    ArenaVector<FAState> touchedBlocks;
+
+    while (!worklist.empty()) {
+
+        FAState b = worklist.back();
+        worklist.pop_back();
+        inWorklist[b] = false;
+        splitter.assign(p.elements.begin() + p.first[b], p.elements.begin() + p.end[b]);
+
+        for (FASymbol c = 0; c < classCount; c++) {
+
+            for (FAState t : splitter) {
+                size_t index = (size_t)t * classCount + c;
+                for (FAState i = predecessorsBegin[index]; i < predecessorsBegin[index + 1]; i++) {
+                    if (p.mark(predecessors[i])) {
+                        touchedBlocks.push_back(p.blockOf[predecessors[i]]);
+                    }
+                }
+            }
+
+            for (FAState y : touchedBlocks) {
+                FAState z = p.split(y);
+                if (z == y) { continue; }
+
+                inWorklist.push_back(false);
+                if (inWorklist[y]) {
+                    worklist.push_back(z);
+                    inWorklist[z] = true;
+                } else {
+                    FAState smaller = p.size(z) < p.size(y) ? z : y;
+                    worklist.push_back(smaller);
+                    inWorklist[smaller] = true;
+                }
+            }
+            touchedBlocks.clear();
+        }
+    }
+
+    // Number groups in order of their smallest state.
+    ArenaVector<FAState> blockGroups(p.first.size(), StateNotFound);
+    FAState groupCount = 0;
+    for (FAState s = 0; s < states; s++) {
+        FAState& g = blockGroups[p.blockOf[s]];
+        if (g == StateNotFound) {
+            g = groupCount++;
+        }
+        groups[s] = g;
+    }
+
+    return groupCount;
+}
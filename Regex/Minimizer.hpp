@@ -0,0 +1,24 @@
+//
+//  Minimizer.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef Minimizer_hpp
+#define Minimizer_hpp
+
+#include "FA.hpp"
+#include "ConstructionArena.hpp"
+
+namespace FAS
+{
+
+// Find equivalent states of a complete DFA with Hopcroft's partition refinement, which takes O(n·k·log n) time for n states and k classes.
+// `transition`[s][c] is the next state of s receiving class c. When called, `groups`[s] is a label of s, and states with different labels are never equivalent (e.g. accept or not).
+// When returned, `groups`[s] is the number of the group s belongs to, and groups are numbered in order of their smallest state. Returns the count of groups.
+FAState minimizeStates(const ArenaVector<ArenaVector<FAState>>& transition, const FASymbol classCount, ArenaVector<FAState>& groups);
+
+}
+
+#endif /* Minimizer_hpp */
@@ -6,9 +6,11 @@
 //
 
 #include <algorithm>
+#include <stdexcept>
 
 #include "NFA.hpp"
 #include "DFA.hpp"
+#include "SubsetArena.hpp"
 
 using namespace FAS;
 
@@ -16,39 +18,180 @@ const unordered_set<FAState> NFA::transitResult(FAState state, FASymbol symbol)
 {
     if (state < 0 || state >= states) { return {}; }
     const auto& map = transition[state];
-    if (!map.contains(symbol)) { return {}; }
-    return map.at(symbol);
+    auto it = map.find(symbol);
+    if (it == map.end()) { return {}; }
+    return {it->second.begin(), it->second.end()};
 }
 
-const unordered_set<FAState> NFA::transitResult(unordered_set<FAState> states, FASymbol symbol) const
+const unordered_set<FAState> NFA::transitResult(const unordered_set<FAState>& states, FASymbol symbol) const
 {
     unordered_set<FAState> temp;
-    for (auto tr = states.begin(); tr != states.end(); tr++) {
-        const unordered_set<FAState>&& tempResult = transitResult(*tr, symbol);
-        temp.insert(tempResult.begin(), tempResult.end());
+    for (const auto& state : states) {
+        if (state >= this->states) { continue; }
+        auto it = transition[state].find(symbol);
+        if (it != transition[state].end()) {
+            temp.insert(it->second.begin(), it->second.end());
+        }
     }
     return temp;
 }
 
-unordered_set<FAState> NFA::collectEmptySymbolReachableStates(unordered_set<FAState> states) const
+void NFA::calculateEmptySymbolClosures(void)
 {
-    unordered_set<FAState> result = states;
-    unordered_set<FAState> temp;
+    closurePool.clear();
+    closureBegin.assign(states + 1, 0);
+
+    SparseSet closure(states);
+    ArenaVector<FAState> stack;
+
+    for (FAState s = 0; s < states; s++) {
+
+        closure.clear();
+        stack.push_back(s);
+        while (!stack.empty()) {
+            FAState state = stack.back();
+            stack.pop_back();
+            if (state >= states || !closure.insert(state) || state >= transition.size()) { continue; }
+            auto it = transition[state].find(EPSILON);
+            if (it != transition[state].end()) {
+                stack.insert(stack.end(), it->second.begin(), it->second.end());
+            }
+        }
+
+        closureBegin[s] = (FAState)closurePool.size();
+        closurePool.insert(closurePool.end(), closure.begin(), closure.end());
+        std::sort(closurePool.begin() + closureBegin[s], closurePool.end());
+    }
+    closureBegin[states] = (FAState)closurePool.size();
+}
+
+unordered_set<FAState> NFA::collectEmptySymbolReachableStates(const unordered_set<FAState>& states) const
+{
+    unordered_set<FAState> result;
+    for (const auto& state : states) {
+        if (state < this->states) {
+            result.insert(closurePool.begin() + closureBegin[state], closurePool.begin() + closureBegin[state + 1]);
+        } else {
+            result.insert(state);
+        }
+    }
+    return result;
+}
+
+unordered_set<FAState> NFA::collectEmptySymbolReachableStates(const unordered_set<FAState>& states, FASymbol symbol) const
+{
+    unordered_set<FAState> result;
+    for (const auto& state : states) {
+        if (state >= this->states) { continue; }
+        auto it = transition[state].find(symbol);
+        if (it == transition[state].end()) { continue; }
+        for (const auto& next : it->second) {
+            if (next < this->states && !result.contains(next)) {
+                result.insert(closurePool.begin() + closureBegin[next], closurePool.begin() + closureBegin[next + 1]);
+            }
+        }
+    }
+    return result;
+}
+
+void NFA::insertEmptySymbolReachableStates(SparseSet& states, const FAState state) const
+{
+    // If `state` is a member, its closure has been inserted with it or with a state reaching it by ε.
+    if (states.contains(state)) { return; }
+    for (FAState i = closureBegin[state]; i < closureBegin[state + 1]; i++) {
+        states.insert(closurePool[i]);
+    }
+}
+
+bool NFA::containAcceptStates(const SparseSet& states) const
+{
+    for (const auto& state : acceptStates) {
+        if (state < this->states && states.contains(state)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NFA::determinize(const ByteClasses& byteClasses, SubsetArena& subsets, ArenaVector<ArenaVector<FAState>>& transition, const bool unanchored, const FAState maxSubsets) const
+{
+    const FASymbol classCount = byteClasses.classCount();
+    const vector<FASymbol> representatives = byteClasses.representatives();
+
+    SparseSet closure(states);
+    ArenaVector<FAState> subset;
+    ArenaVector<FAState> current;
+
+    auto intern = [&]() {
+        subset.assign(closure.begin(), closure.end());
+        std::sort(subset.begin(), subset.end());
+        const FAState id = subsets.intern(subset).first;
+        if (subsets.size() > maxSubsets) {
+            throw std::length_error("too many states for subset construction");
+        }
+        return id;
+    };
 
-    while (!states.empty()) {
-        auto header = states.begin();
-        while (header != states.end()) {
-            const unordered_set<FAState>& tempResult = transitResult(*header, EPSILON);
-            for (auto it = tempResult.begin(); it != tempResult.end(); it++) {
-                if (!result.contains(*it)) {
-                    temp.insert(*it);
+    if (startState < states) {
+        insertEmptySymbolReachableStates(closure, startState);
+    }
+    const ArenaVector<FAState> beginStates(closure.begin(), closure.end());
+    intern();
+
+    // Subsets are numbered as they are found, so walking ids in order determinizes them breadth-first, and only new subsets add work.
+    for (FAState state = 0; state < subsets.size(); state++) {
+        // Interning may move members of `state`, so they are copied first.
+        current.assign(subsets.begin(state), subsets.end(state));
+        transition.emplace_back(classCount);
+
+        // Symbols of a class lead to the same states, so the representative is enough. If it is out of `symbols`, the whole class has no transition.
+        for (FASymbol c = 0; c < classCount; c++) {
+            closure.clear();
+            if (unanchored) {
+                for (const FAState s : beginStates) {
+                    closure.insert(s);
+                }
+            }
+            if (isSymbolInRange(representatives[c])) {
+                for (const FAState s : current) {
+                    auto it = this->transition[s].find(representatives[c]);
+                    if (it == this->transition[s].end()) { continue; }
+                    for (const FAState next : it->second) {
+                        insertEmptySymbolReachableStates(closure, next);
+                    }
                 }
             }
-            header++;
+            transition.back()[c] = intern();
+        }
+    }
+}
+
+ByteClasses NFA::calculateByteClasses(void) const
+{
+    ByteClasses result;
+    vector<unsigned int> labels(ByteClasses::SymbolCount);
+    vector<const StateSet *> targets;
+
+    for (const auto& map : transition) {
+
+        std::fill(labels.begin(), labels.end(), 0);
+        targets.clear();
+
+        // Symbols leading to the same states get the same label, and label 0 means no transition.
+        for (const auto& pair : map) {
+            if (pair.first >= ByteClasses::SymbolCount || pair.second.empty() || !isSymbolInRange(pair.first)) {
+                continue;
+            }
+            auto it = std::find_if(targets.begin(), targets.end(), [&pair](const StateSet *t) { return *t == pair.second; });
+            labels[pair.first] = (unsigned int)(it - targets.begin()) + 1;
+            if (it == targets.end()) {
+                targets.push_back(&pair.second);
+            }
+        }
+
+        if (!targets.empty()) {
+            result.refine(labels);
         }
-        states = temp;
-        temp.clear();
-        result.insert(states.begin(), states.end());
     }
 
     return result;
@@ -58,63 +201,143 @@ const FASymbol NFA::EPSILON = -1; // We use it as an ε which means empty symbol
 
 NFA::NFA(): NFA(0, 0, {}, {{}}) {}
 
-NFA::NFA(const FAState states, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition): FA(states, startState, acceptStates), transition(transition) {}
+ArenaVector<NFA::TransitionMap> NFA::copyTransition(const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition)
+{
+    ArenaVector<TransitionMap> result(transition.size());
+    for (size_t i = 0; i < transition.size(); i++) {
+        for (const auto& pair : transition[i]) {
+            result[i][pair.first].insert(pair.second.begin(), pair.second.end());
+        }
+    }
+    return result;
+}
+
+NFA::NFA(const FAState states, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition): FA(states, startState, acceptStates), transition(copyTransition(transition))
+{
+    calculateEmptySymbolClosures();
+}
 
-NFA::NFA(const FAState states, const vector<pair<FASymbol, FASymbol>>& symbols, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition): FA(states, symbols, startState, acceptStates), transition(transition) {}
+NFA::NFA(const FAState states, const vector<pair<FASymbol, FASymbol>>& symbols, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition): FA(states, symbols, startState, acceptStates), transition(copyTransition(transition))
+{
+    calculateEmptySymbolClosures();
+}
 
 NFA::NFA(const FASymbol specialSymbol): NFA()
 {
-    if ((specialSymbol >= 'a' && specialSymbol <= 'z') || (specialSymbol >= 'A' && specialSymbol <= 'Z')) {
-        states = 2;
-        startState = 0;
-        acceptStates = {1};
-        transition = {
-            {{specialSymbol, {1}}},
-            {}
-        };
-    } else if (specialSymbol == '.') {
-        states = 2;
-        startState = 0;
-        acceptStates = {1};
-        transition = {
-            {},
-            {}
-        };
-        for (char c = 'a'; c <= 'z'; c++) {
-            transition[0][c] = {1};
+    states = 2;
+    symbols = {{0, ByteClasses::SymbolCount - 1}};
+    startState = 0;
+    acceptStates = {1};
+    transition = {
+        {},
+        {}
+    };
+    if (specialSymbol == '.') {
+        for (FASymbol c = 0; c < ByteClasses::SymbolCount; c++) {
+            if (c != '\n') {
+                transition[0][c] = {1};
+            }
+        }
+    } else {
+        transition[0][specialSymbol] = {1};
+        if (specialSymbol < ByteClasses::SymbolCount) {
+            requiredLiteral = {string(1, (char)specialSymbol), true};
         }
     }
+    calculateEmptySymbolClosures();
 }
 
-// Init an NFA with a regex
-NFA::NFA(const string& pattern): NFA()
+NFA::NFA(const string& pattern, const unsigned int flags): NFA(RegexParser(pattern, flags).parse().simplified())
 {
-    NFA n;
-
-    char t = '*';
+    if (states > 0) {
+        simplify();
+    }
+}
 
-    for (auto i = pattern.begin(); i <= pattern.end(); i++) {
+NFA::NFA(const RegexNode& node): NFA()
+{
+    symbols = {{0, ByteClasses::SymbolCount - 1}};
+    transition.clear();
+    startState = addState();
+    acceptStates = {addRegexNode(node, startState)};
+    requiredLiteral = node.requiredLiteral();
+    calculateEmptySymbolClosures();
+}
 
-        if (t != '*') {
+FAState NFA::addState(void)
+{
+    transition.emplace_back();
+    return states++;
+}
 
-            if (t == '.') {
-                n = NFA{'.'};
+FAState NFA::addRegexNode(const RegexNode& node, const FAState start)
+{
+    switch (node.type) {
 
-            } else {
+        case RegexNodeType::Empty:
+            return start;
 
-                n = NFA(t);
+        case RegexNodeType::Class: {
+            const FAState end = addState();
+            for (FASymbol s = 0; s < ByteClasses::SymbolCount; s++) {
+                if (node.symbols.test(s)) {
+                    transition[start][s].insert(end);
+                }
             }
+            return end;
+        }
 
-            if (*i == '*') {
-                n.makeStar();
+        case RegexNodeType::Concatenation: {
+            FAState end = start;
+            for (const auto& child : node.children) {
+                end = addRegexNode(child, end);
             }
+            return end;
+        }
 
-            makeConcatenation(n);
+        case RegexNodeType::Alternation: {
+            // Every alternative gets its own start state, so a loop back to it can not enter another alternative.
+            ArenaVector<FAState> ends;
+            for (const auto& child : node.children) {
+                const FAState childStart = addState();
+                transition[start][EPSILON].insert(childStart);
+                ends.push_back(addRegexNode(child, childStart));
+            }
+            const FAState end = addState();
+            for (const auto& state : ends) {
+                transition[state][EPSILON].insert(end);
+            }
+            return end;
         }
 
-        t = *i;
-    }
+        case RegexNodeType::Repetition: {
+            const RegexNode& child = node.children[0];
+            FAState end = start;
+            for (unsigned int i = 0; i < node.min; i++) {
+                end = addRegexNode(child, end);
+            }
 
+            if (node.max == RegexNode::Unbounded) {
+                // Same as `makeStar`, loop back to a new state instead of `end`, which may have incoming transitions.
+                const FAState loop = addState();
+                transition[end][EPSILON].insert(loop);
+                const FAState childStart = addState();
+                transition[loop][EPSILON].insert(childStart);
+                transition[addRegexNode(child, childStart)][EPSILON].insert(loop);
+                return loop;
+            }
+
+            // x{0,k} is (x(x(...)?)?)?, every optional copy may skip to the final state.
+            const FAState optionalEnd = addState();
+            transition[end][EPSILON].insert(optionalEnd);
+            for (unsigned int i = node.min; i < node.max; i++) {
+                end = addRegexNode(child, end);
+                transition[end][EPSILON].insert(optionalEnd);
+            }
+            return optionalEnd;
+        }
+    }
+    return start;
 }
 
 NFA::NFA(const DFA& d): NFA(std::move(d)) {}
@@ -126,44 +349,56 @@ NFA::NFA(const DFA&& d)
     acceptStates = {};
     transition = {};
 
-    vector<FAState> newStatesMap(d.states);
-    vector<FAState> dterminal{d.terminalStates.begin(), d.terminalStates.end()};
+    ArenaVector<FAState> newStatesMap(d.states);
+    ArenaVector<FAState> dterminal{d.terminalStates.begin(), d.terminalStates.end()};
     std::sort(dterminal.begin(), dterminal.end());
 
     for (FAState i = 0; i < d.states; i++) {
         newStatesMap[i] = i - (FAState)(std::lower_bound(dterminal.begin(), dterminal.end(), i) - dterminal.begin());
     }
 
-    unordered_map<FASymbol, unordered_set<FAState>> tempMap = {};
+    FAState target;
 
-    for (int i = 0; i < d.states; i++) {
+    transition.reserve(states);
+    for (FAState i = 0; i < d.states; i++) {
         if (!d.isTerminalState(i)) {
-            for (auto it = d.transition[i].begin(); it != d.transition[i].end(); it++) {
-                if (!d.isTerminalState(it->second)) {
-                    tempMap[it->first] = {newStatesMap[it->second]};
+            auto& map = transition.emplace_back();
+            for (FASymbol symbol = 0; symbol < ByteClasses::SymbolCount; symbol++) {
+                target = d.transition[i][d.byteClasses.classOf(symbol)];
+                if (!d.isTerminalState(target)) {
+                    map[symbol] = {newStatesMap[target]};
                 }
             }
-            transition.emplace_back(tempMap);
-            tempMap.clear();
         }
     }
 
     startState = newStatesMap[d.startState];
+    requiredLiteral = d.requiredLiteral;
     for (auto s: d.acceptStates) {
         acceptStates.insert(newStatesMap[s]);
     }
+
+    calculateEmptySymbolClosures();
 }
 
 void NFA::receive(const FASymbol symbol)
 {
-    currentStates = collectEmptySymbolReachableStates(transitResult(currentStates, symbol));
+    nextStates.clear();
+    for (const auto& state : currentStates) {
+        auto it = transition[state].find(symbol);
+        if (it == transition[state].end()) { continue; }
+        for (const auto& next : it->second) {
+            insertEmptySymbolReachableStates(nextStates, next);
+        }
+    }
+    std::swap(currentStates, nextStates);
 }
 
 bool NFA::recognize(const string &str)
 {
     resetCurrentStates();
     for (auto it = str.begin(); it != str.end(); it++) {
-        receive(*it);
+        receive((unsigned char)*it);
     }
     return containAcceptStates(currentStates);
 }
@@ -180,7 +415,7 @@ vector<Substring> NFA::findRecognizedSubstrings(const string& str)
     // and `matchedSubstring` stores substring that is being analysed.
     pair<string::const_iterator, unsigned int> matchedSubstring{str.begin(), NothingMatched};
 
-    unordered_set<FAState> startStates = currentStates;
+    beginStates.assign(currentStates);
     bool beginFromStartStates = false;
 
     // Follow the symbol under analysed.
@@ -193,7 +428,7 @@ vector<Substring> NFA::findRecognizedSubstrings(const string& str)
 
     while (parser < str.end()) {
 
-        receive(*parser);
+        receive((unsigned char)*parser);
 
         if (currentStates.empty()) {
 
@@ -204,7 +439,7 @@ vector<Substring> NFA::findRecognizedSubstrings(const string& str)
                 parser++;
             }
             beginFromStartStates = true;
-            currentStates = startStates;
+            currentStates.assign(beginStates);
             matchedSubstring = {parser, NothingMatched};
 
         } else {
@@ -228,12 +463,10 @@ void NFA::makeUnion(const NFA& n)
 {
     if (n.states == 0) { return;}
     if (states == 0) {
-        *this = n;
+        assignKeepingBuilding(n);
         return;
     }
 
-    startState = 0;
-
     unordered_set<FAState> newAcceptStates;
     for (const auto& state: acceptStates) {
         newAcceptStates.insert(state + 1);
@@ -242,57 +475,54 @@ void NFA::makeUnion(const NFA& n)
         newAcceptStates.insert(state + 1 + states);
     }
     acceptStates = newAcceptStates;
+    mergeSymbols(n);
+    requiredLiteral = {};
 
-    vector<unordered_map<FASymbol, unordered_set<FAState>>> newTransition;
-    unordered_map<FASymbol, unordered_set<FAState>> tempMap;
-    unordered_set<FAState> tempSet;
-    newTransition.push_back({{EPSILON, {startState + 1, n.startState + 1 + states}}});
+    ArenaVector<TransitionMap> newTransition;
+    newTransition.reserve(states + n.states + 1);
+    newTransition.emplace_back()[EPSILON] = {startState + 1, n.startState + 1 + states};
+    startState = 0;
 
-    const vector<unordered_map<FASymbol, unordered_set<FAState>>> * transitions[] = {&transition, &n.transition};
+    const ArenaVector<TransitionMap> * transitions[] = {&transition, &n.transition};
     const FAState addons[] = {1, states + 1};
     for (int i = 0; i < 2; i++) {
         for (const auto& map : *(transitions[i])) {
+            auto& newMap = newTransition.emplace_back();
             for (const auto& pair : map) {
+                auto& newSet = newMap[pair.first];
                 for (const auto& state : pair.second) {
-                    tempSet.insert(state + addons[i]);
+                    newSet.insert(state + addons[i]);
                 }
-                tempMap[pair.first] = tempSet;
-                tempSet.clear();
             }
-            newTransition.emplace_back(tempMap);
-            tempMap.clear();
         }
     }
-    transition = newTransition;
+    transition = std::move(newTransition);
 
     states += n.states + 1;
 
-    simplify();
+    finishComposition();
 }
 
 void NFA::makeConcatenation(const NFA& n)
 {
     if (n.states == 0) { return;}
     if (states == 0) {
-        *this = n;
+        assignKeepingBuilding(n);
         return;
     }
 
     for (const auto& state: acceptStates) {
         transition[state][EPSILON].insert(n.startState + states);
     }
-    unordered_map<FASymbol, unordered_set<FAState>> tempMap;
-    unordered_set<FAState> tempSet;
+    transition.reserve(states + n.states);
     for (const auto& map : n.transition) {
+        auto& newMap = transition.emplace_back();
         for (const auto& pair : map) {
+            auto& newSet = newMap[pair.first];
             for (const auto& state : pair.second) {
-                tempSet.insert(state + states);
+                newSet.insert(state + states);
             }
-            tempMap[pair.first] = tempSet;
-            tempSet.clear();
         }
-        transition.emplace_back(tempMap);
-        tempMap.clear();
     }
 
     unordered_set<FAState> newAcceptStates;
@@ -300,29 +530,93 @@ void NFA::makeConcatenation(const NFA& n)
         newAcceptStates.insert(state + states);
     }
     acceptStates = newAcceptStates;
+    mergeSymbols(n);
+    // A literal of either part is required, but only the first part's one is a prefix.
+    if (n.requiredLiteral.literal.size() > requiredLiteral.literal.size()) {
+        requiredLiteral = {n.requiredLiteral.literal, false};
+    }
 
     states += n.states;
 
-    simplify();
+    finishComposition();
 }
 
 void NFA::makeStar(void)
 {
     if (states == 0) { return; }
 
+    // A new start state is needed, because the old one may have incoming transitions, looping back to it should not make them accepted.
+    const FAState newStartState = states;
     for (const auto& state: acceptStates) {
-        transition[state][EPSILON].insert(startState);
+        transition[state][EPSILON].insert(newStartState);
     }
+    transition.resize(states);
+    transition.emplace_back()[EPSILON] = {startState};
+    states++;
+
+    startState = newStartState;
     acceptStates = {startState};
+    requiredLiteral = {};
+
+    if (!building) {
+        calculateEmptySymbolClosures();
+    }
+}
+
+void NFA::mergeSymbols(const NFA& n)
+{
+    for (const auto& range : n.symbols) {
+        if (std::find(symbols.begin(), symbols.end(), range) == symbols.end()) {
+            symbols.push_back(range);
+        }
+    }
+}
+
+void NFA::beginBuilding(void)
+{
+    building = true;
+}
+
+void NFA::finishBuilding(void)
+{
+    if (!building) { return; }
+    building = false;
+    calculateEmptySymbolClosures();
+    if (states > 0) {
+        simplify();
+    }
+}
+
+void NFA::finishComposition(void)
+{
+    if (building) { return; }
+    calculateEmptySymbolClosures();
+    simplify();
+}
+
+void NFA::assignKeepingBuilding(const NFA& n)
+{
+    bool wasBuilding = building;
+    *this = n;
+    building = wasBuilding;
 }
 
 void NFA::resetCurrentStates(void)
 {
-    currentStates = collectEmptySymbolReachableStates({startState});
+    currentStates.reserve(states);
+    nextStates.reserve(states);
+    beginStates.reserve(states);
+
+    currentStates.clear();
+    if (startState < states) {
+        insertEmptySymbolReachableStates(currentStates, startState);
+    }
 }
 
 void NFA::simplify(void)
 {
+    // The DFA and the new NFA are only steps, the result is moved into `transition`, which keeps its allocator.
+    ScratchArena scratch;
     *this = NFA(DFA(*this));
 }
 
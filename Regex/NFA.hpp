@@ -9,11 +9,18 @@
 #define NFA_hpp
 
 #include "FA.hpp"
+#include "ConstructionArena.hpp"
+#include "ByteClasses.hpp"
+#include "SparseSet.hpp"
+#include "RegexParser.hpp"
 
 namespace FAS
 {
 
 class DFA;
+class LazyDFA;
+class RegexSet;
+class SubsetArena;
 
 class NFA: public FA
 {
@@ -21,31 +28,84 @@ private:
 
     static const FASymbol EPSILON; // To indicate an empty symbol.
 
-    unordered_set<FAState> currentStates = {};
-    vector<unordered_map<FASymbol, unordered_set<FAState>>> transition;
+    // Containers built during construction allocate from the current `ConstructionArena`, if any.
+    typedef ArenaSet<FAState> StateSet;
+    typedef ArenaMap<FASymbol, StateSet> TransitionMap;
 
-    unordered_set<FAState> collectEmptySymbolReachableStates(unordered_set<FAState> states) const;
+    ArenaVector<TransitionMap> transition;
+    RequiredLiteral requiredLiteral; // Known from the regex, and passed on to DFAs for prefiltering.
+
+    // ε-closure of state s is the sorted states `closurePool`[`closureBegin`[s], `closureBegin`[s + 1]). They are calculated once whenever `transition` changes.
+    ArenaVector<FAState> closurePool;
+    ArenaVector<FAState> closureBegin;
+
+    // Simulation runs on these preallocated sets, so receiving a symbol does not allocate.
+    SparseSet currentStates;
+    SparseSet nextStates;
+    SparseSet beginStates;
+
+    void calculateEmptySymbolClosures(void);
+
+    static ArenaVector<TransitionMap> copyTransition(const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition);
+
+    unordered_set<FAState> collectEmptySymbolReachableStates(const unordered_set<FAState>& states) const;
+    // Same as `collectEmptySymbolReachableStates(transitResult(states, symbol))`, but the closures are added directly.
+    unordered_set<FAState> collectEmptySymbolReachableStates(const unordered_set<FAState>& states, FASymbol symbol) const;
+
+    // Insert `state` and all states reachable from it by ε into `states`.
+    void insertEmptySymbolReachableStates(SparseSet& states, const FAState state) const;
+    bool containAcceptStates(const SparseSet& states) const;
+
+    // While building, compositions only splice states by Thompson's construction, ε-closures are not calculated and nothing is simplified.
+    bool building = false;
+
+    // Calculate ε-closures and simplify after a composition, unless building.
+    void finishComposition(void);
+    // `*this = n`, without leaving or entering building.
+    void assignKeepingBuilding(const NFA& n);
 
     // Although there is only one start state, but we should also consider ε(aka empty string), this will help set currentStates with startState after considering empty string reachability.
     void resetCurrentStates(void);
 
+    // Add `n`'s symbols that are not in `symbols` yet.
+    void mergeSymbols(const NFA& n);
+
+    FAState addState(void);
+    // Splice `node` after `start` by Thompson's construction, and return the state where it ends.
+    FAState addRegexNode(const RegexNode& node, const FAState start);
+
+    // Symbols are in one class if every state transits them to the same states, symbols out of `symbols` are treated as having no transition.
+    ByteClasses calculateByteClasses(void) const;
+
+    // Subset construction over the classes of `byteClasses`, shared by `DFA` and `RegexSet`. Subsets are interned into `subsets`, numbered breadth-first from the ε-closure of `startState`, which is 0, and their rows are appended to `transition`.
+    // If `unanchored`, that closure joins every subset, as if `startState` looped on every symbol. Throws `std::length_error` if there are more than `maxSubsets` subsets.
+    void determinize(const ByteClasses& byteClasses, SubsetArena& subsets, ArenaVector<ArenaVector<FAState>>& transition, const bool unanchored = false, const FAState maxSubsets = StateNotFound) const;
+
 protected:
 
     const unordered_set<FAState> transitResult(FAState state, FASymbol symbol) const;
-    const unordered_set<FAState> transitResult(unordered_set<FAState> states, FASymbol symbol) const;
+    const unordered_set<FAState> transitResult(const unordered_set<FAState>& states, FASymbol symbol) const;
 
     void simplify(void) override;
 
 public:
 
     friend class DFA;
+    friend class LazyDFA;
+    friend class RegexSet;
+
+    using FA::containAcceptStates;
 
     NFA();
     NFA(const FAState states, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition);
     NFA(const FAState states, const vector<pair<FASymbol, FASymbol>>& symbols, const FAState startState, const unordered_set<FAState>& acceptStates, const vector<unordered_map<FASymbol, unordered_set<FAState>>>& transition);
+    // An NFA of one symbol. '.' is special, it stands for every byte except '\n'.
     NFA(const FASymbol specialSymbol);
-    // Init an NFA with a regex
-    NFA(const string& pattern);
+    // Init an NFA with a regex, see `RegexParser` for the syntax and `RegexFlags` for `flags`. The AST is simplified before construction, and the NFA after.
+    // Throws `RegexSyntaxError` if `pattern` is invalid.
+    NFA(const string& pattern, const unsigned int flags = NoFlags);
+    // Init an NFA with a parsed regex by Thompson's construction. It is not simplified, so it suits `LazyDFA` for patterns too large to determinize.
+    NFA(const RegexNode& node);
 
     NFA(const DFA& d);
     NFA(const DFA&& d);
@@ -59,6 +119,11 @@ public:
     void makeConcatenation(const NFA& n);
     void makeStar(void);
 
+    // Between these two calls, `makeUnion`, `makeConcatenation` and `makeStar` are cheap, and the NFA is determinized and simplified only once by `finishBuilding`.
+    // An NFA being built can only be composed, call `finishBuilding` before matching with it or converting it.
+    void beginBuilding(void);
+    void finishBuilding(void);
+
 };
 
 }
@@ -0,0 +1,327 @@
+//
+//  ParallelMatcher.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <numeric>
+
+#include "ParallelMatcher.hpp"
+
+using namespace FAS;
+
+ParallelMatcher::ParallelMatcher(const DenseDFA& dfa, const unsigned int threadCount): dfa(dfa), pool(threadCount) {}
+
+vector<const unsigned char *> ParallelMatcher::chunkBoundaries(const unsigned char *begin, const unsigned char *end) const
+{
+    const size_t size = end - begin;
+    const size_t count = std::max((size_t)1, std::min((size_t)pool.size() * ChunksPerThread, size / MinChunkSize));
+    if (pool.size() == 1 || count == 1) {
+        return {begin, end};
+    }
+
+    vector<const unsigned char *> result;
+    for (size_t i = 0; i < count; i++) {
+        result.push_back(begin + size / count * i);
+    }
+    result.push_back(end);
+    return result;
+}
+
+template <typename T>
+FAState ParallelMatcher::run(const T *rows, FAState state, const unsigned char *parser, const unsigned char *end) const
+{
+    // Same as `DenseDFA::recognize`, but from any state.
+    parser = dfa.skipLoops(state, parser, end);
+    while (parser < end && state != DenseDFA::DeadState) {
+        const FAState next = rows[(size_t)state * dfa.alphabetSize + dfa.byteClasses.classOf(*parser++)];
+        if (next != state) {
+            state = next;
+            parser = dfa.skipLoops(state, parser, end);
+        }
+    }
+    return state;
+}
+
+template <typename T>
+ParallelMatcher::ChunkRun ParallelMatcher::runFromEveryState(const T *rows, const unsigned char *begin, const unsigned char *end) const
+{
+    ChunkRun result;
+    result.converged = true;
+    result.lanes.resize(dfa.states);
+    std::iota(result.lanes.begin(), result.lanes.end(), 0);
+    result.laneOf = result.lanes;
+
+    // Lanes are run block by block and merged after every block. Blocks grow, so lanes which meet at once are merged soon, and the rest are not checked too often.
+    vector<FAState> laneOfState(dfa.states, StateNotFound);
+    vector<FAState> merged;
+    vector<FAState> mergedLane;
+    const unsigned char *parser = begin;
+    size_t blockSize = 64;
+    while (parser < end && result.lanes.size() > 1) {
+        const unsigned char *blockEnd = parser + std::min(blockSize, (size_t)(end - parser));
+        for (FAState& lane : result.lanes) {
+            lane = run(rows, lane, parser, blockEnd);
+        }
+        parser = blockEnd;
+
+        merged.clear();
+        mergedLane.resize(result.lanes.size());
+        for (size_t i = 0; i < result.lanes.size(); i++) {
+            const FAState s = result.lanes[i];
+            if (laneOfState[s] == StateNotFound) {
+                laneOfState[s] = (FAState)merged.size();
+                merged.push_back(s);
+            }
+            mergedLane[i] = laneOfState[s];
+        }
+        for (FAState s : merged) {
+            laneOfState[s] = StateNotFound;
+        }
+        for (FAState& lane : result.laneOf) {
+            lane = mergedLane[lane];
+        }
+        result.lanes.swap(merged);
+
+        if (result.lanes.size() > MaxLanes && (size_t)(parser - begin) >= MaxConvergenceDistance) {
+            result.converged = false;
+            return result;
+        }
+        blockSize = std::min(blockSize * 2, MinChunkSize / 16);
+    }
+
+    if (result.lanes.size() == 1) {
+        result.lanes[0] = run(rows, result.lanes[0], parser, end);
+    }
+    return result;
+}
+
+template <typename T>
+bool ParallelMatcher::recognize(const T *rows, const unsigned char *begin, const unsigned char *end)
+{
+    const vector<const unsigned char *> boundaries = chunkBoundaries(begin, end);
+    const size_t count = boundaries.size() - 1;
+    // With many states, runs from every state would cost more than they save, so the buffer is run sequentially.
+    const size_t chunkSize = boundaries[1] - boundaries[0];
+    if (count == 1 || (size_t)dfa.states * MaxConvergenceDistance * MinSpeculationRatio > chunkSize) {
+        return run(rows, dfa.startState, begin, end) >= dfa.firstAcceptState;
+    }
+
+    // Only the first chunk knows the state it begins with, the others are run from every state, then the state is carried through them in order.
+    FAState state = DenseDFA::DeadState;
+    vector<ChunkRun> runs(count);
+    pool.run(count, [&](size_t i) {
+        if (i == 0) {
+            state = run(rows, dfa.startState, boundaries[0], boundaries[1]);
+        } else {
+            runs[i] = runFromEveryState(rows, boundaries[i], boundaries[i + 1]);
+        }
+    });
+
+    for (size_t i = 1; i < count && state != DenseDFA::DeadState; i++) {
+        const ChunkRun& r = runs[i];
+        state = r.converged ? r.lanes[r.laneOf[state]] : run(rows, state, boundaries[i], boundaries[i + 1]);
+    }
+    return state >= dfa.firstAcceptState;
+}
+
+template <typename T, typename OnRestart>
+void ParallelMatcher::scan(const T *rows, Scan& scan, const unsigned char *stop, const unsigned char *data, const unsigned char *end, vector<StreamSubstring>& result, OnRestart onRestart) const
+{
+    // Same as `DenseDFA::findRecognizedSubstrings`, except that the scan can stop and go on, and the prefilter may not know where to restart before `stop`.
+    FAState state = scan.state;
+    const unsigned char *parser = scan.parser;
+    const unsigned char *matchBegin = scan.matchBegin;
+    const unsigned char *matchEnd = scan.matchEnd;
+    const unsigned char *nextCheck = scan.nextCheck;
+    bool beginFromStartState = scan.beginFromStartState;
+
+    auto save = [&](const bool restartPending) {
+        scan = {state, parser, matchBegin, matchEnd, nextCheck, beginFromStartState, restartPending};
+    };
+
+    auto accelerate = [&]() {
+        const unsigned char *next = dfa.skipLoops(state, parser, end);
+        if (next != parser) {
+            parser = next;
+            beginFromStartState = false;
+            if (state >= dfa.firstAcceptState) {
+                matchEnd = parser;
+            }
+        }
+    };
+
+    // Returns false if the scan stops here.
+    auto restart = [&]() {
+        beginFromStartState = true;
+        state = dfa.startState;
+        matchEnd = nullptr;
+        if (parser >= nextCheck && dfa.prefilter.isActive()) {
+            const unsigned char *found = dfa.prefilter.skipBefore(parser, stop, end, nextCheck);
+            if (found == nullptr) {
+                matchBegin = parser;
+                save(true);
+                return false;
+            }
+            parser = found;
+        }
+        matchBegin = parser;
+        if (onRestart(parser)) {
+            save(false);
+            return false;
+        }
+        accelerate();
+        return true;
+    };
+
+    if (scan.restartPending) {
+        if (!restart()) { return; }
+    } else {
+        accelerate();
+    }
+
+    while (parser < stop) {
+
+        const FAState next = rows[(size_t)state * dfa.alphabetSize + dfa.byteClasses.classOf(*parser)];
+
+        if (next == DenseDFA::DeadState) {
+
+            if (matchEnd != nullptr) {
+                result.push_back({(uint64_t)(matchBegin - data), (uint64_t)(matchEnd - matchBegin)});
+            }
+            if (beginFromStartState) {
+                parser++;
+            }
+            if (!restart()) { return; }
+
+        } else {
+
+            beginFromStartState = false;
+            parser++;
+            if (next >= dfa.firstAcceptState) {
+                matchEnd = parser;
+            }
+            if (next != state) {
+                state = next;
+                accelerate();
+            }
+        }
+    }
+
+    save(false);
+}
+
+template <typename T>
+vector<StreamSubstring> ParallelMatcher::findRecognizedSubstrings(const T *rows, const unsigned char *begin, const unsigned char *end)
+{
+    vector<StreamSubstring> result;
+    if (dfa.startState == DenseDFA::DeadState) { return result; }
+
+    const vector<const unsigned char *> boundaries = chunkBoundaries(begin, end);
+    const size_t count = boundaries.size() - 1;
+    auto never = [](const unsigned char *) { return false; };
+
+    // Only the beginning is considered for the empty string, and other chunks begin as if an attempt had just died before them.
+    vector<ChunkScan> chunks(count);
+    const unsigned char *emptyMatch = dfa.startState >= dfa.firstAcceptState ? begin : nullptr;
+    chunks[0].scan = {dfa.startState, begin, begin, emptyMatch, begin, false, emptyMatch == nullptr && dfa.prefilter.isActive()};
+    for (size_t i = 1; i < count; i++) {
+        chunks[i].scan = {dfa.startState, boundaries[i], boundaries[i], nullptr, boundaries[i], true, true};
+    }
+
+    if (count == 1) {
+        scan(rows, chunks[0].scan, end, begin, end, result, never);
+    } else {
+        pool.run(count, [&](size_t i) {
+            ChunkScan& c = chunks[i];
+            if (i == 0) {
+                scan(rows, c.scan, boundaries[1], begin, end, c.matches, never);
+                return;
+            }
+            // Stop when enough restarts are recorded, and go on without recording.
+            scan(rows, c.scan, boundaries[i + 1], begin, end, c.matches, [&c](const unsigned char *position) {
+                c.restarts.push_back(position);
+                return c.restarts.size() == MaxRecordedRestarts;
+            });
+            if (c.restarts.size() == MaxRecordedRestarts) {
+                scan(rows, c.scan, boundaries[i + 1], begin, end, c.matches, never);
+            }
+        });
+        size_t total = 0;
+        for (const ChunkScan& c : chunks) {
+            total += c.matches.size();
+        }
+        result.reserve(total + count);
+        result.insert(result.end(), chunks[0].matches.begin(), chunks[0].matches.end());
+        vector<StreamSubstring>().swap(chunks[0].matches);
+    }
+
+    // The real scan goes on into every chunk until it restarts where the chunk scan did, then the rest of the chunk is taken from the chunk scan.
+    // If they never meet, which needs a match in progress longer than all recorded restarts, the real scan does the whole chunk itself.
+    Scan carried = chunks[0].scan;
+    for (size_t i = 1; i < count; i++) {
+        ChunkScan& c = chunks[i];
+        if (carried.restartPending && c.restarts.empty()) {
+            // No occurrence of the literal begins in this chunk, so nothing changes.
+            continue;
+        }
+
+        size_t next = 0;
+        const unsigned char *met = nullptr;
+        scan(rows, carried, boundaries[i + 1], begin, end, result, [&](const unsigned char *position) {
+            while (next < c.restarts.size() && c.restarts[next] < position) {
+                next++;
+            }
+            if (next < c.restarts.size() && c.restarts[next] == position) {
+                met = position;
+                return true;
+            }
+            return false;
+        });
+
+        if (met != nullptr) {
+            const uint64_t offset = met - begin;
+            auto first = std::partition_point(c.matches.begin(), c.matches.end(), [offset](const StreamSubstring& m) { return m.first < offset; });
+            result.insert(result.end(), first, c.matches.end());
+            carried = c.scan;
+        }
+        vector<StreamSubstring>().swap(c.matches);
+    }
+
+    if (carried.matchEnd != nullptr) {
+        result.push_back({(uint64_t)(carried.matchBegin - begin), (uint64_t)(carried.matchEnd - carried.matchBegin)});
+    }
+    return result;
+}
+
+bool ParallelMatcher::recognize(const char *data, const size_t size)
+{
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(data);
+    switch (dfa.stateWidth) {
+        case 1: return recognize(reinterpret_cast<const uint8_t *>(dfa.table), begin, begin + size);
+        case 2: return recognize(reinterpret_cast<const uint16_t *>(dfa.table), begin, begin + size);
+        default: return recognize(reinterpret_cast<const uint32_t *>(dfa.table), begin, begin + size);
+    }
+}
+
+bool ParallelMatcher::recognize(const std::string_view str)
+{
+    return recognize(str.data(), str.size());
+}
+
+vector<StreamSubstring> ParallelMatcher::findRecognizedSubstrings(const char *data, const size_t size)
+{
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(data);
+    switch (dfa.stateWidth) {
+        case 1: return findRecognizedSubstrings(reinterpret_cast<const uint8_t *>(dfa.table), begin, begin + size);
+        case 2: return findRecognizedSubstrings(reinterpret_cast<const uint16_t *>(dfa.table), begin, begin + size);
+        default: return findRecognizedSubstrings(reinterpret_cast<const uint32_t *>(dfa.table), begin, begin + size);
+    }
+}
+
+vector<StreamSubstring> ParallelMatcher::findRecognizedSubstrings(const std::string_view str)
+{
+    return findRecognizedSubstrings(str.data(), str.size());
+}
@@ -0,0 +1,99 @@
+//
+//  ParallelMatcher.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef ParallelMatcher_hpp
+#define ParallelMatcher_hpp
+
+#include "DenseDFA.hpp"
+#include "ThreadPool.hpp"
+
+namespace FAS
+{
+
+// Matches a `DenseDFA` against one large buffer with all threads of a pool. The buffer is cut into chunks which are scanned at the same time, then the chunk results are stitched in order.
+// Results are always the same as the sequential ones, positions are 64-bit so buffers may be longer than 4GB. `dfa` must outlive the matcher.
+class ParallelMatcher
+{
+private:
+
+    static constexpr size_t MinChunkSize = (size_t)1 << 20; // Smaller buffers are scanned by the calling thread alone.
+    static constexpr size_t ChunksPerThread = 4; // More chunks than threads, so a slow chunk does not keep the others waiting.
+    static constexpr size_t MaxRecordedRestarts = 4096; // A chunk scan keeps this many restarts for the scan before it to meet, which is nearly always at one of the first.
+    static constexpr size_t MaxLanes = 4; // Runs from every state of a chunk must come down to this many lanes
+    static constexpr size_t MaxConvergenceDistance = 4096; // within this many bytes.
+    static constexpr size_t MinSpeculationRatio = 8; // Runs from every state may take up to `states` × `MaxConvergenceDistance` bytes, so they are tried only on chunks this many times larger.
+
+    // Where a scan of `findRecognizedSubstrings` is, so it can stop at the end of a chunk and go on in the next one.
+    struct Scan
+    {
+        FAState state;
+        const unsigned char *parser;
+        const unsigned char *matchBegin; // The substring that is being analysed,
+        const unsigned char *matchEnd; // and the end of its longest match so far, or nullptr.
+        const unsigned char *nextCheck;
+        bool beginFromStartState;
+        bool restartPending; // A restart at `parser` is not done yet, because the prefilter found no occurrence before the end of the chunk to restart at.
+    };
+
+    // A chunk scanned as if an attempt had died right before it, and the positions of its first restarts. Once the real scan restarts at one of them, both go the same way.
+    struct ChunkScan
+    {
+        Scan scan;
+        vector<StreamSubstring> matches;
+        vector<const unsigned char *> restarts;
+    };
+
+    // A chunk run from every live state at the same time. `lanes` are the distinct states they have come to, and `laneOf[s]` is the lane of the run begun from s.
+    // A run from each state would cost `states` times a sequential run, but most runs fall into the same states within a few bytes, so they are merged as they meet.
+    struct ChunkRun
+    {
+        bool converged; // False if the runs did not meet soon enough, and the chunk is left to the sequential stitching.
+        vector<FAState> lanes;
+        vector<FAState> laneOf;
+    };
+
+    const DenseDFA& dfa;
+    ThreadPool pool;
+
+    // Cut [`begin`, `end`) into chunks, the result has the boundaries of them, from `begin` to `end`.
+    vector<const unsigned char *> chunkBoundaries(const unsigned char *begin, const unsigned char *end) const;
+
+    template <typename T>
+    FAState run(const T *rows, FAState state, const unsigned char *parser, const unsigned char *end) const;
+
+    template <typename T>
+    ChunkRun runFromEveryState(const T *rows, const unsigned char *begin, const unsigned char *end) const;
+
+    template <typename T>
+    bool recognize(const T *rows, const unsigned char *begin, const unsigned char *end);
+
+    // Go on with `scan` until it passes `stop`, the end of its chunk, then the match in progress is kept in `scan`. The prefilter and accelerations look ahead until `end`, like a scan of the whole buffer.
+    // `onRestart(position)` is called after every restart, and the scan stops there if it returns true.
+    template <typename T, typename OnRestart>
+    void scan(const T *rows, Scan& scan, const unsigned char *stop, const unsigned char *data, const unsigned char *end, vector<StreamSubstring>& result, OnRestart onRestart) const;
+
+    template <typename T>
+    vector<StreamSubstring> findRecognizedSubstrings(const T *rows, const unsigned char *begin, const unsigned char *end);
+
+public:
+
+    // `threadCount` of 0 is taken as 1.
+    ParallelMatcher(const DenseDFA& dfa, const unsigned int threadCount = std::thread::hardware_concurrency());
+
+    // The same as those of `DenseDFA`.
+    bool recognize(const char *data, const size_t size);
+    bool recognize(std::string_view str);
+    vector<StreamSubstring> findRecognizedSubstrings(const char *data, const size_t size);
+    vector<StreamSubstring> findRecognizedSubstrings(std::string_view str);
+
+    unsigned int threadCount(void) const { return pool.size(); }
+
+};
+
+}
+
+#endif /* ParallelMatcher_hpp */
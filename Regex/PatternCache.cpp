@@ -0,0 +1,89 @@
+//
+//  PatternCache.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include "PatternCache.hpp"
+#include "NFA.hpp"
+#include "DFA.hpp"
+#include "ConstructionArena.hpp"
+
+using namespace FAS;
+
+PatternCache::PatternCache(const size_t memoryLimit): memoryLimit(memoryLimit) {}
+
+std::shared_ptr<const DenseDFA> PatternCache::get(const string& pattern, const unsigned int flags)
+{
+    Key key(pattern, flags);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            counters.hits++;
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->dfa;
+        }
+        counters.misses++;
+    }
+
+    // Compile without holding the lock, so other patterns are not kept waiting. If another thread compiles the same pattern meanwhile, the first one cached is kept.
+    // Only the dense table is kept, so the NFA and DFA are built in an arena released at once.
+    std::shared_ptr<const DenseDFA> dfa;
+    {
+        ConstructionArena arena;
+        dfa = std::make_shared<const DenseDFA>(DFA(NFA(pattern, flags)));
+    }
+    const size_t usage = dfa->memoryUsage() + sizeof(Entry) + 2 * pattern.capacity();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->dfa;
+    }
+    if (usage > memoryLimit) {
+        return dfa;
+    }
+    entries.push_front({key, dfa, usage});
+    index.emplace(std::move(key), entries.begin());
+    counters.entries++;
+    counters.memoryUsage += usage;
+    evict();
+    return dfa;
+}
+
+void PatternCache::evict(void)
+{
+    while (counters.memoryUsage > memoryLimit && !entries.empty()) {
+        const Entry& last = entries.back();
+        counters.memoryUsage -= last.memoryUsage;
+        counters.entries--;
+        counters.evictions++;
+        index.erase(last.key);
+        entries.pop_back();
+    }
+}
+
+PatternCache::Statistics PatternCache::statistics(void) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void PatternCache::setMemoryLimit(const size_t memoryLimit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->memoryLimit = memoryLimit;
+    evict();
+}
+
+void PatternCache::clear(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    entries.clear();
+    counters.entries = 0;
+    counters.memoryUsage = 0;
+}
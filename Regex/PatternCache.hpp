@@ -0,0 +1,80 @@
+//
+//  PatternCache.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef PatternCache_hpp
+#define PatternCache_hpp
+
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "HashValue.h"
+#include "DenseDFA.hpp"
+#include "RegexParser.hpp"
+
+namespace FAS
+{
+
+// A thread-safe cache of compiled patterns, so a pattern used again is not parsed, determinized and minimized again.
+// The least recently used patterns are evicted when the automata take more than `memoryLimit` bytes in all.
+class PatternCache
+{
+public:
+
+    static constexpr size_t DefaultMemoryLimit = (size_t)64 << 20;
+
+    struct Statistics
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t memoryUsage = 0;
+    };
+
+private:
+
+    typedef pair<string, unsigned int> Key; // A pattern and its `RegexFlags`.
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return hash_val(key.first, key.second); }
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const DenseDFA> dfa;
+        size_t memoryUsage;
+    };
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries; // The most recently used first.
+    unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    size_t memoryLimit;
+    Statistics counters;
+
+    // Evict from the back until `entries` fit in `memoryLimit`. `mutex` must be held.
+    void evict(void);
+
+public:
+
+    PatternCache(const size_t memoryLimit = DefaultMemoryLimit);
+
+    // Returns the automaton of `pattern`, compiling it if it is not cached. It may be used by several threads at the same time through the const matching methods, and stays valid while it is held, even if it is evicted meanwhile.
+    // Throws `RegexSyntaxError` like `RegexParser`. An automaton larger than `memoryLimit` is returned without being cached.
+    std::shared_ptr<const DenseDFA> get(const string& pattern, const unsigned int flags = NoFlags);
+
+    Statistics statistics(void) const;
+    void setMemoryLimit(const size_t memoryLimit);
+    void clear(void);
+
+};
+
+}
+
+#endif /* PatternCache_hpp */
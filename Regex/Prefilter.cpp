@@ -0,0 +1,53 @@
+//
+//  Prefilter.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include "Prefilter.hpp"
+
+using namespace FAS;
+
+Prefilter::Prefilter(): literal(), killers(), skipsToLiteral(false), active(false) {}
+
+Prefilter::Prefilter(const RequiredLiteral& required, const ByteFlags& killers): literal(required.literal), killers(killers), skipsToLiteral(false), active(false)
+{
+    if (literal.empty()) { return; }
+    skipsToLiteral = required.isPrefix && literal.find(literal[0], 1) == string::npos;
+    active = skipsToLiteral || std::find(killers.begin(), killers.end(), true) != killers.end();
+}
+
+const unsigned char *Prefilter::skip(const unsigned char *position, const unsigned char *end, const unsigned char *&nextCheck) const
+{
+    const unsigned char *result = skipBefore(position, end, end, nextCheck);
+    if (result == nullptr) {
+        nextCheck = end;
+        return end;
+    }
+    return result;
+}
+
+const unsigned char *Prefilter::skipBefore(const unsigned char *position, const unsigned char *limit, const unsigned char *end, const unsigned char *&nextCheck) const
+{
+    const unsigned char *searchEnd = limit < end && (size_t)(end - limit) >= literal.size() ? limit + literal.size() - 1 : end;
+    const void *found = memmem(position, searchEnd - position, literal.data(), literal.size());
+    if (found == nullptr) {
+        return nullptr;
+    }
+
+    const unsigned char *occurrence = static_cast<const unsigned char *>(found);
+    nextCheck = occurrence + 1;
+    if (skipsToLiteral) {
+        return occurrence;
+    }
+    for (const unsigned char *p = occurrence; p > position; p--) {
+        if (killers[p[-1]]) {
+            return p;
+        }
+    }
+    return position;
+}
@@ -0,0 +1,52 @@
+//
+//  Prefilter.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef Prefilter_hpp
+#define Prefilter_hpp
+
+#include <array>
+
+#include "ByteClasses.hpp"
+#include "RegexNode.hpp"
+
+namespace FAS
+{
+
+typedef std::array<bool, ByteClasses::SymbolCount> ByteFlags;
+
+// Skips a scan over input where no match can begin, by searching for a literal every match contains with `memmem`.
+// A scan restarts at the symbol where its previous attempt died, so the scan must be skipped to a position it would restart at anyway, or the result changes:
+// if every match begins with the literal, and its first byte does not recur in it, no attempt begun before an occurrence can survive into it, so the scan restarts at the occurrence;
+// otherwise, after a byte on which every live state dies (a "killer", like '\n' for most patterns), the scan always restarts at the next byte, so it restarts after the last killer before the occurrence.
+class Prefilter
+{
+private:
+
+    string literal;
+    ByteFlags killers;
+    bool skipsToLiteral;
+    bool active;
+
+public:
+
+    Prefilter();
+    Prefilter(const RequiredLiteral& required, const ByteFlags& killers);
+
+    bool isActive(void) const { return active; }
+    const ByteFlags& killerBytes(void) const { return killers; }
+
+    // When a scan restarts at `position` from the start state, returns where it can restart instead with the same result, which is `end` if nothing can match.
+    // Restarts before `nextCheck`, which is set to the position after the occurrence found, would be skipped to the same occurrence, so the prefilter need not be asked before it.
+    const unsigned char *skip(const unsigned char *position, const unsigned char *end, const unsigned char *&nextCheck) const;
+    // Same as `skip`, but only occurrences beginning before `limit` are searched for, and nullptr is returned if there is none, since where to restart is not known yet.
+    const unsigned char *skipBefore(const unsigned char *position, const unsigned char *limit, const unsigned char *end, const unsigned char *&nextCheck) const;
+
+};
+
+}
+
+#endif /* Prefilter_hpp */
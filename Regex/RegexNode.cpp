@@ -0,0 +1,345 @@
+//
+//  RegexNode.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+
+#include "RegexNode.hpp"
+
+using namespace FAS;
+
+RegexNode RegexNode::makeEmpty(void)
+{
+    return RegexNode();
+}
+
+RegexNode RegexNode::makeClass(const SymbolSet& symbols)
+{
+    RegexNode node;
+    node.type = RegexNodeType::Class;
+    node.symbols = symbols;
+    return node;
+}
+
+RegexNode RegexNode::makeLiteral(const FASymbol symbol)
+{
+    SymbolSet symbols;
+    symbols.set(symbol);
+    return makeClass(symbols);
+}
+
+RegexNode RegexNode::makeConcatenation(vector<RegexNode>&& children)
+{
+    RegexNode node;
+    node.type = RegexNodeType::Concatenation;
+    node.children = std::move(children);
+    return node;
+}
+
+RegexNode RegexNode::makeAlternation(vector<RegexNode>&& children)
+{
+    RegexNode node;
+    node.type = RegexNodeType::Alternation;
+    node.children = std::move(children);
+    return node;
+}
+
+RegexNode RegexNode::makeRepetition(RegexNode&& child, const unsigned int min, const unsigned int max)
+{
+    RegexNode node;
+    node.type = RegexNodeType::Repetition;
+    node.children.emplace_back(std::move(child));
+    node.min = min;
+    node.max = max;
+    return node;
+}
+
+bool RegexNode::operator==(const RegexNode& n) const
+{
+    if (type != n.type) { return false; }
+    switch (type) {
+        case RegexNodeType::Empty:
+            return true;
+        case RegexNodeType::Class:
+            return symbols == n.symbols;
+        case RegexNodeType::Repetition:
+            return min == n.min && max == n.max && children == n.children;
+        default:
+            return children == n.children;
+    }
+}
+
+bool RegexNode::isNullable(void) const
+{
+    switch (type) {
+        case RegexNodeType::Empty:
+            return true;
+        case RegexNodeType::Class:
+            return false;
+        case RegexNodeType::Concatenation:
+            return std::all_of(children.begin(), children.end(), [](const RegexNode& n) { return n.isNullable(); });
+        case RegexNodeType::Alternation:
+            return std::any_of(children.begin(), children.end(), [](const RegexNode& n) { return n.isNullable(); });
+        case RegexNodeType::Repetition:
+            return min == 0 || children[0].isNullable();
+    }
+    return false;
+}
+
+// Items of `node` if it is a concatenation, or `node` itself otherwise. The empty string has no item.
+static vector<RegexNode> sequenceOf(const RegexNode& node)
+{
+    if (node.type == RegexNodeType::Concatenation) { return node.children; }
+    if (node.type == RegexNodeType::Empty) { return {}; }
+    return {node};
+}
+
+static RegexNode simplifyAlternation(const vector<RegexNode>& children)
+{
+    // Flatten nested alternations, merge classes into the place of the first one, and drop duplicates.
+    vector<RegexNode> alternatives;
+    SymbolSet merged;
+    long classIndex = -1;
+
+    for (const auto& child : children) {
+        RegexNode c = child.simplified();
+        vector<RegexNode> items;
+        if (c.type == RegexNodeType::Alternation) {
+            items = std::move(c.children);
+        } else {
+            items.emplace_back(std::move(c));
+        }
+        for (auto& item : items) {
+            if (item.type == RegexNodeType::Class) {
+                if (classIndex < 0) {
+                    classIndex = (long)alternatives.size();
+                    alternatives.emplace_back(RegexNode::makeClass(SymbolSet()));
+                }
+                merged |= item.symbols;
+            } else if (std::find(alternatives.begin(), alternatives.end(), item) == alternatives.end()) {
+                alternatives.emplace_back(std::move(item));
+            }
+        }
+    }
+    if (classIndex >= 0) {
+        alternatives[classIndex] = RegexNode::makeClass(merged);
+    }
+
+    // Factor out the common first item of alternatives, in order of its first appearance.
+    vector<RegexNode> factored;
+    vector<bool> used(alternatives.size(), false);
+
+    for (size_t i = 0; i < alternatives.size(); i++) {
+
+        if (used[i]) { continue; }
+        used[i] = true;
+
+        vector<RegexNode> sequence = sequenceOf(alternatives[i]);
+        if (sequence.empty()) {
+            factored.emplace_back(std::move(alternatives[i]));
+            continue;
+        }
+
+        vector<RegexNode> rests;
+        for (size_t j = i + 1; j < alternatives.size(); j++) {
+            if (used[j]) { continue; }
+            vector<RegexNode> other = sequenceOf(alternatives[j]);
+            if (!other.empty() && other[0] == sequence[0]) {
+                used[j] = true;
+                rests.emplace_back(RegexNode::makeConcatenation(vector<RegexNode>(other.begin() + 1, other.end())));
+            }
+        }
+
+        if (rests.empty()) {
+            factored.emplace_back(std::move(alternatives[i]));
+            continue;
+        }
+
+        rests.insert(rests.begin(), RegexNode::makeConcatenation(vector<RegexNode>(sequence.begin() + 1, sequence.end())));
+        factored.emplace_back(RegexNode::makeConcatenation({sequence[0], RegexNode::makeAlternation(std::move(rests))}).simplified());
+    }
+
+    if (factored.size() == 1) {
+        return std::move(factored[0]);
+    }
+
+    // `x|` is `x?`.
+    auto empty = std::find(factored.begin(), factored.end(), RegexNode::makeEmpty());
+    if (empty != factored.end()) {
+        factored.erase(empty);
+        RegexNode rest = factored.size() == 1 ? std::move(factored[0]) : RegexNode::makeAlternation(std::move(factored));
+        return rest.isNullable() ? rest : RegexNode::makeRepetition(std::move(rest), 0, 1);
+    }
+
+    return RegexNode::makeAlternation(std::move(factored));
+}
+
+RegexNode RegexNode::simplified(void) const
+{
+    switch (type) {
+
+        case RegexNodeType::Empty:
+        case RegexNodeType::Class:
+            return *this;
+
+        case RegexNodeType::Concatenation: {
+            vector<RegexNode> items;
+            for (const auto& child : children) {
+                RegexNode c = child.simplified();
+                if (c.type == RegexNodeType::Concatenation) {
+                    items.insert(items.end(), std::make_move_iterator(c.children.begin()), std::make_move_iterator(c.children.end()));
+                } else if (c.type != RegexNodeType::Empty) {
+                    items.emplace_back(std::move(c));
+                }
+            }
+            if (items.empty()) { return makeEmpty(); }
+            if (items.size() == 1) { return std::move(items[0]); }
+            return makeConcatenation(std::move(items));
+        }
+
+        case RegexNodeType::Alternation:
+            return simplifyAlternation(children);
+
+        case RegexNodeType::Repetition: {
+            RegexNode child = children[0].simplified();
+            if (max == 0 || child.type == RegexNodeType::Empty) { return makeEmpty(); }
+            if (min == 1 && max == 1) { return child; }
+
+            if (child.type == RegexNodeType::Repetition && max == Unbounded && min <= 1) {
+                // (x{a,}){b,} is x{a·b,} when a, b <= 1, and (x?){b,} is x*.
+                if (child.max == Unbounded && child.min <= 1) {
+                    return makeRepetition(std::move(child.children[0]), min * child.min, Unbounded);
+                }
+                if (child.min == 0 && child.max == 1) {
+                    return makeRepetition(std::move(child.children[0]), 0, Unbounded);
+                }
+            }
+            return makeRepetition(std::move(child), min, max);
+        }
+    }
+    return *this;
+}
+
+namespace
+{
+
+const size_t MaxLiteralLength = 256; // Literals are cut to this length, a part of a required literal is still required.
+
+// Literals of a subexpression: every match of it begins with `prefix`, ends with `suffix` and contains `required`. If `exact`, `prefix` is the only string it matches.
+struct LiteralInfo
+{
+    bool exact = false;
+    string prefix;
+    string suffix;
+    string required;
+};
+
+LiteralInfo exactInfo(const string& s)
+{
+    if (s.size() > MaxLiteralLength) {
+        return {false, s.substr(0, MaxLiteralLength), s.substr(s.size() - MaxLiteralLength), s.substr(0, MaxLiteralLength)};
+    }
+    return {true, s, s, s};
+}
+
+const string& longer(const string& a, const string& b)
+{
+    return b.size() > a.size() ? b : a;
+}
+
+LiteralInfo concatenate(const LiteralInfo& a, const LiteralInfo& b)
+{
+    if (a.exact && b.exact) {
+        return exactInfo(a.prefix + b.prefix);
+    }
+    LiteralInfo result;
+    result.prefix = a.exact ? (a.prefix + b.prefix).substr(0, MaxLiteralLength) : a.prefix;
+    result.suffix = b.exact ? a.suffix + b.suffix : b.suffix;
+    if (result.suffix.size() > MaxLiteralLength) {
+        result.suffix = result.suffix.substr(result.suffix.size() - MaxLiteralLength);
+    }
+    result.required = longer(longer(a.required, b.required), (a.suffix + b.prefix).substr(0, MaxLiteralLength));
+    result.required = longer(longer(result.required, result.prefix), result.suffix);
+    return result;
+}
+
+LiteralInfo literalInfo(const RegexNode& node)
+{
+    switch (node.type) {
+
+        case RegexNodeType::Empty:
+            return exactInfo("");
+
+        case RegexNodeType::Class:
+            if (node.isLiteral()) {
+                unsigned int symbol = 0;
+                while (!node.symbols.test(symbol)) { symbol++; }
+                return exactInfo(string(1, (char)symbol));
+            }
+            return {};
+
+        case RegexNodeType::Concatenation: {
+            LiteralInfo result = exactInfo("");
+            for (const auto& child : node.children) {
+                result = concatenate(result, literalInfo(child));
+            }
+            return result;
+        }
+
+        case RegexNodeType::Alternation: {
+            // Only the common prefix and suffix of all alternatives are required.
+            vector<LiteralInfo> infos;
+            for (const auto& child : node.children) {
+                infos.push_back(literalInfo(child));
+            }
+            LiteralInfo result = infos[0];
+            for (size_t i = 1; i < infos.size(); i++) {
+                const LiteralInfo& info = infos[i];
+                result.exact = result.exact && info.exact && result.prefix == info.prefix;
+                size_t n = 0;
+                while (n < result.prefix.size() && n < info.prefix.size() && result.prefix[n] == info.prefix[n]) { n++; }
+                result.prefix.resize(n);
+                n = 0;
+                while (n < result.suffix.size() && n < info.suffix.size() && result.suffix[result.suffix.size() - 1 - n] == info.suffix[info.suffix.size() - 1 - n]) { n++; }
+                result.suffix.erase(0, result.suffix.size() - n);
+            }
+            if (!result.exact) {
+                result.required = longer(result.prefix, result.suffix);
+            }
+            return result;
+        }
+
+        case RegexNodeType::Repetition: {
+            if (node.min == 0) {
+                return node.max == 0 ? exactInfo("") : LiteralInfo();
+            }
+            LiteralInfo child = literalInfo(node.children[0]);
+            if (!child.exact) {
+                // A repeated match still begins with the prefix of the first copy, ends with the suffix of the last one, and contains the required literal of every copy.
+                return {false, child.prefix, child.suffix, child.required};
+            }
+            string repeated;
+            for (unsigned int i = 0; i < node.min && repeated.size() <= MaxLiteralLength; i++) {
+                repeated += child.prefix;
+            }
+            LiteralInfo result = exactInfo(repeated);
+            result.exact = result.exact && node.min == node.max;
+            return result;
+        }
+    }
+    return {};
+}
+
+}
+
+RequiredLiteral RegexNode::requiredLiteral(void) const
+{
+    LiteralInfo info = literalInfo(*this);
+    if (!info.prefix.empty() && info.prefix.size() >= info.required.size()) {
+        return {info.prefix, true};
+    }
+    return {info.required, false};
+}
@@ -0,0 +1,72 @@
+//
+//  RegexNode.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef RegexNode_hpp
+#define RegexNode_hpp
+
+#include <bitset>
+
+#include "FA.hpp"
+
+namespace FAS
+{
+
+typedef std::bitset<256> SymbolSet; // A set of byte symbols, the `symbols` of a `Class` node.
+
+enum class RegexNodeType
+{
+    Empty,          // Matches the empty string only.
+    Class,          // Matches one symbol of `symbols`, a literal is a class with one symbol.
+    Concatenation,  // Matches `children` one after another.
+    Alternation,    // Matches any of `children`.
+    Repetition,     // Matches `children`[0] repeated [`min`, `max`] times.
+};
+
+// A literal which every match of a regex contains.
+struct RequiredLiteral
+{
+    string literal; // Empty if there is none.
+    bool isPrefix = false; // Every match begins with `literal`.
+};
+
+// A node of the abstract syntax tree of a regex.
+struct RegexNode
+{
+    static constexpr unsigned int Unbounded = -1; // `max` of a repetition without upper bound.
+
+    RegexNodeType type = RegexNodeType::Empty;
+    SymbolSet symbols;
+    vector<RegexNode> children;
+    unsigned int min = 0;
+    unsigned int max = 0;
+
+    static RegexNode makeEmpty(void);
+    static RegexNode makeClass(const SymbolSet& symbols);
+    static RegexNode makeLiteral(const FASymbol symbol);
+    static RegexNode makeConcatenation(vector<RegexNode>&& children);
+    static RegexNode makeAlternation(vector<RegexNode>&& children);
+    static RegexNode makeRepetition(RegexNode&& child, const unsigned int min, const unsigned int max);
+
+    bool operator==(const RegexNode& n) const;
+
+    bool isLiteral(void) const { return type == RegexNodeType::Class && symbols.count() == 1; }
+
+    // Whether the node matches the empty string.
+    bool isNullable(void) const;
+
+    // An equivalent tree which is cheaper to turn into an automaton: nested concatenations and alternations are flattened, classes in an alternation are merged,
+    // common prefixes of alternatives are factored out (`abc|abd` becomes `ab[cd]`), and trivial or nested repetitions are reduced.
+    RegexNode simplified(void) const;
+
+    // The longest literal found which every match contains, a prefix of every match is preferred when it is as long as the longest inner literal.
+    RequiredLiteral requiredLiteral(void) const;
+
+};
+
+}
+
+#endif /* RegexNode_hpp */
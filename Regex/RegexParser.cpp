@@ -0,0 +1,354 @@
+//
+//  RegexParser.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+
+#include "RegexParser.hpp"
+
+using namespace FAS;
+
+RegexSyntaxError::RegexSyntaxError(const string& message, const size_t position): std::invalid_argument(message + " at position " + std::to_string(position)), position(position) {}
+
+RegexParser::RegexParser(const string& pattern, const unsigned int flags): pattern(pattern), flags(flags), position(0) {}
+
+void RegexParser::fail(const string& message) const
+{
+    throw RegexSyntaxError(message, position);
+}
+
+RegexNode RegexParser::parse(void)
+{
+    position = 0;
+    RegexNode result = parseAlternation();
+    if (!atEnd()) {
+        // `parseAlternation` only stops early at a ')'.
+        fail("unmatched ')'");
+    }
+    if (expandedSize(result) > MaxExpandedSize) {
+        fail("pattern expands beyond " + std::to_string(MaxExpandedSize) + " symbols");
+    }
+    return result;
+}
+
+RegexNode RegexParser::parseAlternation(void)
+{
+    vector<RegexNode> alternatives;
+    alternatives.emplace_back(parseConcatenation());
+    while (!atEnd() && peek() == '|') {
+        position++;
+        alternatives.emplace_back(parseConcatenation());
+    }
+    if (alternatives.size() == 1) {
+        return std::move(alternatives[0]);
+    }
+    return RegexNode::makeAlternation(std::move(alternatives));
+}
+
+RegexNode RegexParser::parseConcatenation(void)
+{
+    vector<RegexNode> items;
+    while (!atEnd() && peek() != '|' && peek() != ')') {
+        items.emplace_back(parseRepetition());
+    }
+    if (items.empty()) {
+        return RegexNode::makeEmpty();
+    }
+    if (items.size() == 1) {
+        return std::move(items[0]);
+    }
+    return RegexNode::makeConcatenation(std::move(items));
+}
+
+RegexNode RegexParser::parseRepetition(void)
+{
+    RegexNode node = parseAtom();
+
+    while (!atEnd()) {
+        const size_t operatorPosition = position;
+        unsigned int min, max;
+        switch (peek()) {
+            case '*': min = 0; max = RegexNode::Unbounded; position++; break;
+            case '+': min = 1; max = RegexNode::Unbounded; position++; break;
+            case '?': min = 0; max = 1; position++; break;
+            case '{':
+                if (!parseBounds(min, max)) { return node; }
+                break;
+            default:
+                return node;
+        }
+        node = RegexNode::makeRepetition(std::move(node), min, max);
+        if (expandedSize(node) > MaxExpandedSize) {
+            position = operatorPosition;
+            fail("repetition expands beyond " + std::to_string(MaxExpandedSize) + " symbols");
+        }
+    }
+
+    return node;
+}
+
+size_t RegexParser::expandedSize(const RegexNode& node)
+{
+    size_t size = 0;
+    switch (node.type) {
+        case RegexNodeType::Empty:
+            break;
+        case RegexNodeType::Class:
+            size = 1;
+            break;
+        case RegexNodeType::Concatenation:
+        case RegexNodeType::Alternation:
+            for (const auto& child : node.children) {
+                size = std::min(size + expandedSize(child), MaxExpandedSize + 1);
+            }
+            break;
+        case RegexNodeType::Repetition: {
+            // `x{m,}` is m copies of `x` with the last one looped, `x{m,n}` is n copies.
+            const size_t copies = node.max == RegexNode::Unbounded ? std::max(node.min, 1u) : node.max;
+            size = std::min(expandedSize(node.children[0]) * copies, MaxExpandedSize + 1);
+            break;
+        }
+    }
+    return size;
+}
+
+bool RegexParser::parseBounds(unsigned int& min, unsigned int& max)
+{
+    size_t p = position + 1;
+
+    auto parseNumber = [this, &p](unsigned int& number) {
+        size_t begin = p;
+        number = 0;
+        while (p < pattern.size() && pattern[p] >= '0' && pattern[p] <= '9') {
+            number = number * 10 + (pattern[p++] - '0');
+            if (number > MaxRepetition) {
+                position = begin;
+                fail("repetition bound exceeds " + std::to_string(MaxRepetition));
+            }
+        }
+        return p > begin;
+    };
+
+    if (!parseNumber(min)) { return false; }
+    max = min;
+    if (p < pattern.size() && pattern[p] == ',') {
+        p++;
+        if (!parseNumber(max)) {
+            max = RegexNode::Unbounded;
+        }
+    }
+    if (p >= pattern.size() || pattern[p] != '}') { return false; }
+
+    if (min > max) {
+        fail("repetition bounds out of order");
+    }
+    position = p + 1;
+    return true;
+}
+
+RegexNode RegexParser::parseAtom(void)
+{
+    unsigned char c = peek();
+    SymbolSet symbols;
+
+    switch (c) {
+
+        case '(': {
+            position++;
+            if (pattern.compare(position, 2, "?:") == 0) {
+                position += 2;
+            } else if (!atEnd() && peek() == '?') {
+                fail("unsupported group syntax");
+            }
+            RegexNode node = parseAlternation();
+            if (atEnd()) {
+                fail("missing ')'");
+            }
+            position++;
+            return node;
+        }
+
+        case '[':
+            position++;
+            return parseClass();
+
+        case '.':
+            position++;
+            symbols.set();
+            if (!(flags & DotMatchesNewline)) {
+                symbols.reset('\n');
+            }
+            return RegexNode::makeClass(symbols);
+
+        case '\\':
+            position++;
+            parseEscape(symbols);
+            return RegexNode::makeClass(foldCase(symbols));
+
+        case '*':
+        case '+':
+        case '?':
+            fail("nothing to repeat");
+
+        case '^':
+        case '$':
+            fail("anchors are not supported");
+
+        default:
+            position++;
+            symbols.set(c);
+            return RegexNode::makeClass(foldCase(symbols));
+    }
+}
+
+RegexNode RegexParser::parseClass(void)
+{
+    SymbolSet symbols;
+    bool negated = false;
+
+    if (!atEnd() && peek() == '^') {
+        negated = true;
+        position++;
+    }
+
+    bool first = true;
+    while (true) {
+
+        if (atEnd()) {
+            fail("missing ']'");
+        }
+        if (peek() == ']' && !first) {
+            position++;
+            break;
+        }
+        first = false;
+
+        // A single symbol starting a possible range, or a class escape.
+        SymbolSet item;
+        if (peek() == '\\') {
+            position++;
+            parseEscape(item);
+        } else {
+            item.set(peek());
+            position++;
+        }
+
+        if (item.count() == 1 && position + 1 < pattern.size() && peek() == '-' && pattern[position + 1] != ']') {
+            unsigned int low = 0;
+            while (!item.test(low)) { low++; }
+            position++;
+
+            SymbolSet upper;
+            if (peek() == '\\') {
+                position++;
+                parseEscape(upper);
+            } else {
+                upper.set(peek());
+                position++;
+            }
+            if (upper.count() != 1) {
+                fail("invalid range end");
+            }
+            unsigned int high = 0;
+            while (!upper.test(high)) { high++; }
+            if (low > high) {
+                fail("range out of order");
+            }
+            for (unsigned int s = low; s <= high; s++) {
+                item.set(s);
+            }
+        }
+
+        symbols |= item;
+    }
+
+    symbols = foldCase(symbols);
+    if (negated) {
+        symbols.flip();
+    }
+    return RegexNode::makeClass(symbols);
+}
+
+void RegexParser::parseEscape(SymbolSet& symbols)
+{
+    if (atEnd()) {
+        fail("trailing '\\'");
+    }
+
+    auto hexValue = [](unsigned char c) -> int {
+        if (c >= '0' && c <= '9') { return c - '0'; }
+        if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+        if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+        return -1;
+    };
+
+    unsigned char c = peek();
+    position++;
+
+    SymbolSet temp;
+    switch (c) {
+        case 'n': symbols.set('\n'); return;
+        case 'r': symbols.set('\r'); return;
+        case 't': symbols.set('\t'); return;
+        case 'f': symbols.set('\f'); return;
+        case 'v': symbols.set('\v'); return;
+        case 'a': symbols.set('\a'); return;
+        case 'e': symbols.set(0x1b); return;
+        case '0': symbols.set(0); return;
+
+        case 'x': {
+            if (position + 2 > pattern.size() || hexValue(pattern[position]) < 0 || hexValue(pattern[position + 1]) < 0) {
+                fail("invalid '\\x' escape");
+            }
+            symbols.set(hexValue(pattern[position]) * 16 + hexValue(pattern[position + 1]));
+            position += 2;
+            return;
+        }
+
+        case 'd':
+        case 'D':
+            for (unsigned int s = '0'; s <= '9'; s++) { temp.set(s); }
+            break;
+
+        case 'w':
+        case 'W':
+            for (unsigned int s = '0'; s <= '9'; s++) { temp.set(s); }
+            for (unsigned int s = 'a'; s <= 'z'; s++) { temp.set(s); temp.set(s - 'a' + 'A'); }
+            temp.set('_');
+            break;
+
+        case 's':
+        case 'S':
+            for (unsigned char s : {' ', '\t', '\n', '\r', '\f', '\v'}) { temp.set(s); }
+            break;
+
+        default:
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+                position--;
+                fail(string("unknown escape '\\") + (char)c + "'");
+            }
+            symbols.set(c);
+            return;
+    }
+
+    // An uppercase class escape is the complement of the lowercase one.
+    symbols |= (c >= 'A' && c <= 'Z') ? ~temp : temp;
+}
+
+SymbolSet RegexParser::foldCase(const SymbolSet& symbols) const
+{
+    if (!(flags & CaseInsensitive)) { return symbols; }
+
+    SymbolSet result = symbols;
+    for (unsigned int s = 'a'; s <= 'z'; s++) {
+        const unsigned int upper = s - 'a' + 'A';
+        if (symbols.test(s) || symbols.test(upper)) {
+            result.set(s);
+            result.set(upper);
+        }
+    }
+    return result;
+}
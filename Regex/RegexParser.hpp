@@ -0,0 +1,89 @@
+//
+//  RegexParser.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef RegexParser_hpp
+#define RegexParser_hpp
+
+#include <stdexcept>
+
+#include "RegexNode.hpp"
+
+namespace FAS
+{
+
+enum RegexFlags: unsigned int
+{
+    NoFlags = 0,
+    CaseInsensitive = 1 << 0, // Letters match both of their cases.
+    DotMatchesNewline = 1 << 1, // `.` matches every byte, not every byte except '\n'.
+};
+
+// Thrown by `RegexParser::parse` for an invalid pattern.
+class RegexSyntaxError: public std::invalid_argument
+{
+public:
+
+    const size_t position; // Offset of the byte where the pattern became invalid.
+
+    RegexSyntaxError(const string& message, const size_t position);
+
+};
+
+// A recursive-descent parser of regexes over bytes, with this grammar:
+//
+//     alternation   := concatenation ('|' concatenation)*
+//     concatenation := repetition*
+//     repetition    := atom ('*' | '+' | '?' | '{m}' | '{m,}' | '{m,n}')*
+//     atom          := '(' alternation ')' | '(?:' alternation ')' | '[' class ']' | '.' | '\' escape | byte
+//
+// Escapes are `\n \r \t \f \v \a \e \0`, `\xHH`, the classes `\d \D \w \W \s \S`, and a backslash before any other punctuation stands for itself.
+// A class may be negated by a leading `^`, a `]` right after `[` or `[^` and a `-` at either end are literal.
+// A `{` not starting a valid bound is literal. Matching is over whole strings or substrings, so the anchors `^` and `$` are rejected.
+class RegexParser
+{
+private:
+
+    static constexpr unsigned int MaxRepetition = 1000; // Bounds of `{m,n}` are limited because each repetition is a copy in the automaton.
+    static constexpr size_t MaxExpandedSize = 100000; // Nested bounds multiply, so the classes of the pattern with every repetition copied out are limited too.
+
+    const string pattern;
+    const unsigned int flags;
+    size_t position;
+
+    bool atEnd(void) const { return position >= pattern.size(); }
+    unsigned char peek(void) const { return pattern[position]; }
+
+    [[noreturn]] void fail(const string& message) const;
+
+    RegexNode parseAlternation(void);
+    RegexNode parseConcatenation(void);
+    RegexNode parseRepetition(void);
+    RegexNode parseAtom(void);
+    RegexNode parseClass(void);
+
+    // Parse the escape after a '\', and add the symbols it stands for to `symbols`.
+    void parseEscape(SymbolSet& symbols);
+    // Try to parse `{m}`, `{m,}` or `{m,n}` at `position`, leaving `position` untouched on failure.
+    bool parseBounds(unsigned int& min, unsigned int& max);
+
+    // Classes in `node` once every repetition is copied out, which is what the automaton holds, or `MaxExpandedSize` + 1 if there are more.
+    static size_t expandedSize(const RegexNode& node);
+
+    // Apply `CaseInsensitive` to a class.
+    SymbolSet foldCase(const SymbolSet& symbols) const;
+
+public:
+
+    RegexParser(const string& pattern, const unsigned int flags = NoFlags);
+
+    RegexNode parse(void);
+
+};
+
+}
+
+#endif /* RegexParser_hpp */
@@ -0,0 +1,235 @@
+//
+//  RegexSet.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <map>
+
+#include "RegexSet.hpp"
+#include "NFA.hpp"
+#include "SubsetArena.hpp"
+#include "Minimizer.hpp"
+
+using namespace FAS;
+
+RegexSet::RegexSet(const vector<string>& patterns, const unsigned int flags): FA(0, {{0, ByteClasses::SymbolCount - 1}}, 0, {}), patterns((unsigned int)patterns.size()), currentState(0)
+{
+    // One Thompson NFA for all patterns, its start state has ε to the start of each of them.
+    NFA n;
+    n.symbols = symbols;
+    n.transition.clear();
+    n.startState = n.addState();
+    n.acceptStates.clear();
+
+    vector<unsigned int> acceptIds;
+    for (unsigned int id = 0; id < this->patterns; id++) {
+        RegexNode node = RegexParser(patterns[id], flags).parse().simplified();
+        const FAState start = n.addState();
+        n.transition[n.startState][NFA::EPSILON].insert(start);
+        const FAState end = n.addRegexNode(node, start);
+        n.acceptStates.insert(end);
+        acceptIds.resize(n.states, StateNotFound);
+        acceptIds[end] = id;
+    }
+    acceptIds.resize(n.states, StateNotFound);
+    n.calculateEmptySymbolClosures();
+
+    byteClasses = n.calculateByteClasses();
+    anchored = compile(n, acceptIds, false);
+    unanchored = compile(n, acceptIds, true);
+
+    states = (FAState)anchored.matchBegin.size() - 1;
+    startState = anchored.startState;
+    for (FAState s = 0; s < states; s++) {
+        if (anchored.isMatchState(s)) {
+            acceptStates.insert(s);
+        }
+    }
+    currentState = startState;
+}
+
+RegexSet::Table RegexSet::compile(const NFA& n, const vector<unsigned int>& acceptIds, const bool unanchored) const
+{
+    const FASymbol classCount = byteClasses.classCount();
+
+    SubsetArena subsets;
+    ArenaVector<ArenaVector<FAState>> transition;
+    n.determinize(byteClasses, subsets, transition, unanchored, MaxStates);
+    const FAState subsetCount = subsets.size();
+
+    // Label states by the sets of ids they accept.
+    vector<vector<unsigned int>> ids(subsetCount);
+    std::map<vector<unsigned int>, FAState> labelMap;
+    ArenaVector<FAState> groups(subsetCount);
+    for (FAState s = 0; s < subsetCount; s++) {
+        for (auto it = subsets.begin(s); it != subsets.end(s); it++) {
+            if (acceptIds[*it] != StateNotFound) {
+                ids[s].push_back(acceptIds[*it]);
+            }
+        }
+        std::sort(ids[s].begin(), ids[s].end());
+        groups[s] = labelMap.emplace(ids[s], (FAState)labelMap.size()).first->second;
+    }
+
+    const FAState groupCount = minimizeStates(transition, classCount, groups);
+
+    Table result;
+    result.startState = groups[0];
+    result.transition.resize((size_t)groupCount * classCount);
+    result.matchBegin.assign(groupCount + 1, 0);
+
+    vector<FAState> representative(groupCount, StateNotFound);
+    for (FAState s = 0; s < subsetCount; s++) {
+        if (representative[groups[s]] == StateNotFound) {
+            representative[groups[s]] = s;
+        }
+    }
+    for (FAState g = 0; g < groupCount; g++) {
+        const FAState s = representative[g];
+        for (FASymbol c = 0; c < classCount; c++) {
+            result.transition[(size_t)g * classCount + c] = groups[transition[s][c]];
+        }
+        result.matchPool.insert(result.matchPool.end(), ids[s].begin(), ids[s].end());
+        result.matchBegin[g + 1] = (unsigned int)result.matchPool.size();
+    }
+
+    // Every state which can not reach a match state is merged into one by minimizing, and it loops to itself on every class.
+    for (FAState g = 0; g < groupCount; g++) {
+        if (result.isMatchState(g)) { continue; }
+        bool dead = true;
+        for (FASymbol c = 0; c < classCount && dead; c++) {
+            dead = result.transition[(size_t)g * classCount + c] == g;
+        }
+        if (dead) {
+            result.deadState = g;
+            break;
+        }
+    }
+
+    return result;
+}
+
+vector<unsigned int> RegexSet::recognizedPatterns(const std::string_view str) const
+{
+    const FASymbol classCount = byteClasses.classCount();
+    FAState state = anchored.startState;
+    for (auto it = str.begin(); it != str.end() && state != anchored.deadState; it++) {
+        state = anchored.transition[(size_t)state * classCount + byteClasses.classOf((unsigned char)*it)];
+    }
+    return vector<unsigned int>(anchored.matchPool.begin() + anchored.matchBegin[state], anchored.matchPool.begin() + anchored.matchBegin[state + 1]);
+}
+
+vector<unsigned int> RegexSet::findRecognizedPatterns(const std::string_view str) const
+{
+    const FASymbol classCount = byteClasses.classCount();
+    vector<bool> found(patterns, false);
+    vector<bool> visited(unanchored.matchBegin.size() - 1, false);
+    unsigned int foundCount = 0;
+
+    // Collect ids of a match state once per call.
+    auto collect = [&](const FAState state) {
+        visited[state] = true;
+        for (unsigned int i = unanchored.matchBegin[state]; i < unanchored.matchBegin[state + 1]; i++) {
+            if (!found[unanchored.matchPool[i]]) {
+                found[unanchored.matchPool[i]] = true;
+                foundCount++;
+            }
+        }
+    };
+
+    FAState state = unanchored.startState;
+    collect(state);
+    for (auto it = str.begin(); it != str.end() && foundCount < patterns && state != unanchored.deadState; it++) {
+        state = unanchored.transition[(size_t)state * classCount + byteClasses.classOf((unsigned char)*it)];
+        if (!visited[state] && unanchored.isMatchState(state)) {
+            collect(state);
+        }
+    }
+
+    vector<unsigned int> result;
+    for (unsigned int id = 0; id < patterns; id++) {
+        if (found[id]) {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
+
+void RegexSet::receive(const FASymbol symbol)
+{
+    // As in `DFA`, a symbol the set can not receive leaves no state to go on from, whether or not the table has a dead state.
+    if (currentState == StateNotFound || symbol >= ByteClasses::SymbolCount) {
+        currentState = StateNotFound;
+        return;
+    }
+    currentState = anchored.transition[(size_t)currentState * byteClasses.classCount() + byteClasses.classOf(symbol)];
+}
+
+bool RegexSet::recognize(const string& str)
+{
+    return !recognizedPatterns(str).empty();
+}
+
+vector<Substring> RegexSet::findRecognizedSubstrings(const string& str)
+{
+    resetCurrentState();
+
+    const unsigned int NothingMatched = -1;
+
+    // `result` stores all matched substring,
+    vector<Substring> result;
+
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(str.data());
+    const unsigned char *end = begin + str.size();
+
+    // and `matchBegin` with `matchedLength` stores substring that is being analysed.
+    const unsigned char *matchBegin = begin;
+    unsigned int matchedLength = anchored.isMatchState(anchored.startState) ? 0 : NothingMatched;
+
+    FAState state = anchored.startState;
+    bool beginFromStartState = false;
+
+    // Follow the symbol under analysed.
+    const unsigned char *parser = begin;
+
+    while (parser < end) {
+
+        state = anchored.transition[(size_t)state * byteClasses.classCount() + byteClasses.classOf(*parser)];
+
+        if (state == anchored.deadState) {
+
+            if (matchedLength != NothingMatched) {
+                result.push_back({(unsigned int)(matchBegin - begin), matchedLength});
+            }
+            if (beginFromStartState) {
+                parser++;
+            }
+            beginFromStartState = true;
+            state = anchored.startState;
+            matchBegin = parser;
+            matchedLength = NothingMatched;
+
+        } else {
+
+            beginFromStartState = false;
+            parser++;
+            if (anchored.isMatchState(state)) {
+                matchedLength = (unsigned int)(parser - matchBegin);
+            }
+        }
+    }
+
+    if (matchedLength != NothingMatched) {
+        result.push_back({(unsigned int)(matchBegin - begin), matchedLength});
+    }
+
+    return result;
+}
+
+void RegexSet::resetCurrentState(void)
+{
+    currentState = anchored.startState;
+}
@@ -0,0 +1,79 @@
+//
+//  RegexSet.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef RegexSet_hpp
+#define RegexSet_hpp
+
+#include <string_view>
+
+#include "FA.hpp"
+#include "ByteClasses.hpp"
+#include "RegexParser.hpp"
+
+namespace FAS
+{
+
+class NFA;
+
+// A set of regexes compiled into one minimized DFA, whose accept states carry the ids of the patterns they accept. An id is the index of a pattern in the constructor's `patterns`.
+// Matching reports every matching pattern in a single pass, so the cost per symbol does not grow with the count of patterns.
+class RegexSet: public FA
+{
+private:
+
+    // A complete, minimized DFA over `byteClasses`.
+    struct Table
+    {
+        FAState startState = 0;
+        FAState deadState = StateNotFound; // The state accepting nothing at all, if there is one.
+        vector<FAState> transition; // transition[s * classCount + c] is the next state of s receiving class c.
+        // Ids of patterns accepted by s are `matchPool`[`matchBegin`[s], `matchBegin`[s + 1]), in ascending order.
+        vector<unsigned int> matchPool;
+        vector<unsigned int> matchBegin;
+
+        bool isMatchState(const FAState s) const { return matchBegin[s] != matchBegin[s + 1]; }
+    };
+
+    unsigned int patterns;
+    ByteClasses byteClasses;
+    Table anchored; // Recognizes the patterns.
+    Table unanchored; // Recognizes the patterns preceded by anything, so it reaches a match state wherever a match ends.
+
+    FAState currentState;
+
+    // Subset construction of `n` by `NFA::determinize`, whose accept state s accepts the pattern `acceptIds`[s], then minimization keeping states of different sets of ids apart.
+    // If `unanchored`, the start states are added to every subset, as if the start state looped on every symbol.
+    Table compile(const NFA& n, const vector<unsigned int>& acceptIds, const bool unanchored) const;
+
+    void resetCurrentState(void);
+
+public:
+
+    // Subset construction may grow exponentially with the patterns, so it stops at this many states.
+    static constexpr FAState MaxStates = 1 << 18;
+
+    // Throws `RegexSyntaxError` if any of `patterns` is invalid, and `std::length_error` if either automaton needs more than `MaxStates` states before minimizing.
+    RegexSet(const vector<string>& patterns, const unsigned int flags = NoFlags);
+
+    unsigned int patternCount(void) const { return patterns; }
+
+    // Ids of patterns matching the whole `str`, in ascending order.
+    vector<unsigned int> recognizedPatterns(std::string_view str) const;
+    // Ids of patterns matching any substring of `str`, in ascending order.
+    vector<unsigned int> findRecognizedPatterns(std::string_view str) const;
+
+    // These treat the set as the union of its patterns.
+    // Before using `receive`, make sure the `currentState` is what you need. Call `resetCurrentState` if you want to begin from `startState`.
+    void receive(const FASymbol symbol) override;
+    bool recognize(const string& str) override;
+    vector<Substring> findRecognizedSubstrings(const string& str) override;
+
+};
+
+}
+
+#endif /* RegexSet_hpp */
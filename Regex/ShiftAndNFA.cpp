@@ -0,0 +1,275 @@
+//
+//  ShiftAndNFA.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ShiftAndNFA.hpp"
+
+using namespace FAS;
+
+namespace
+{
+
+typedef uint64_t StateSet;
+
+// The Glushkov sets of a subexpression.
+struct Fragment
+{
+    bool nullable = true;
+    StateSet first = 0;
+    StateSet last = 0;
+};
+
+// Numbers positions of a regex from 1 in order of appearance, and collects what follows each of them.
+struct GlushkovBuilder
+{
+    unsigned int positions = 0;
+    std::array<StateSet, 64> follow{};
+    std::array<StateSet, ByteClasses::SymbolCount> positionsOf{};
+
+    Fragment concatenate(const Fragment& a, const Fragment& b)
+    {
+        for (unsigned int p = 1; p <= positions; p++) {
+            if (a.last >> p & 1) {
+                follow[p] |= b.first;
+            }
+        }
+        return {a.nullable && b.nullable, a.nullable ? a.first | b.first : a.first, b.nullable ? a.last | b.last : b.last};
+    }
+
+    Fragment loop(Fragment f)
+    {
+        for (unsigned int p = 1; p <= positions; p++) {
+            if (f.last >> p & 1) {
+                follow[p] |= f.first;
+            }
+        }
+        return f;
+    }
+
+    Fragment build(const RegexNode& node)
+    {
+        switch (node.type) {
+
+            case RegexNodeType::Empty:
+                return {};
+
+            case RegexNodeType::Class: {
+                if (++positions > ShiftAndNFA::MaxPositions) {
+                    throw std::length_error("too many positions for ShiftAndNFA");
+                }
+                const StateSet bit = (StateSet)1 << positions;
+                for (FASymbol s = 0; s < ByteClasses::SymbolCount; s++) {
+                    if (node.symbols.test(s)) {
+                        positionsOf[s] |= bit;
+                    }
+                }
+                return {false, bit, bit};
+            }
+
+            case RegexNodeType::Concatenation: {
+                Fragment result;
+                for (const auto& child : node.children) {
+                    result = concatenate(result, build(child));
+                }
+                return result;
+            }
+
+            case RegexNodeType::Alternation: {
+                Fragment result{false, 0, 0};
+                for (const auto& child : node.children) {
+                    Fragment f = build(child);
+                    result = {result.nullable || f.nullable, result.first | f.first, result.last | f.last};
+                }
+                return result;
+            }
+
+            case RegexNodeType::Repetition: {
+                const RegexNode& child = node.children[0];
+                Fragment result;
+                if (node.max == RegexNode::Unbounded) {
+                    // x{m,} is x{m-1}x+, or x* if m is 0.
+                    for (unsigned int i = 1; i < node.min; i++) {
+                        result = concatenate(result, build(child));
+                    }
+                    Fragment f = loop(build(child));
+                    if (node.min == 0) {
+                        f.nullable = true;
+                    }
+                    return concatenate(result, f);
+                }
+
+                for (unsigned int i = 0; i < node.min; i++) {
+                    result = concatenate(result, build(child));
+                }
+                // x{0,k} is (x(x(...)?)?)?. Copies are built from left to right, so that they are numbered in order, and nested from right to left.
+                vector<Fragment> copies;
+                for (unsigned int i = node.min; i < node.max; i++) {
+                    copies.push_back(build(child));
+                }
+                Fragment optional;
+                for (auto it = copies.rbegin(); it != copies.rend(); it++) {
+                    optional = concatenate(*it, optional);
+                    optional.nullable = true;
+                }
+                return concatenate(result, optional);
+            }
+        }
+        return {};
+    }
+};
+
+}
+
+unsigned int ShiftAndNFA::positionCount(const RegexNode& node)
+{
+    const unsigned long long limit = MaxPositions + 1;
+    unsigned long long count = 0;
+
+    switch (node.type) {
+        case RegexNodeType::Empty:
+            return 0;
+        case RegexNodeType::Class:
+            return 1;
+        case RegexNodeType::Concatenation:
+        case RegexNodeType::Alternation:
+            for (const auto& child : node.children) {
+                count += positionCount(child);
+            }
+            break;
+        case RegexNodeType::Repetition: {
+            unsigned long long copies = node.max == RegexNode::Unbounded ? std::max(node.min, 1u) : node.max;
+            count = copies * positionCount(node.children[0]);
+            break;
+        }
+    }
+    return (unsigned int)std::min(count, limit);
+}
+
+ShiftAndNFA::ShiftAndNFA(const RegexNode& node): FA(0, {{0, ByteClasses::SymbolCount - 1}}, 0, {}), currentStates(1), acceptMask(0), shiftMask(0)
+{
+    GlushkovBuilder builder;
+    Fragment f = builder.build(node);
+
+    states = builder.positions + 1;
+    positionsOf = builder.positionsOf;
+    // The initial state is followed by the first positions.
+    builder.follow[0] = f.first;
+
+    acceptMask = f.last | (f.nullable ? 1 : 0);
+    for (FAState s = 0; s < states; s++) {
+        if (acceptMask >> s & 1) {
+            acceptStates.insert(s);
+        }
+    }
+
+    // Split transitions into shifts and irregular ones, which are grouped by the chunk of 8 positions they come from.
+    std::array<StateSet, 64> irregular{};
+    for (FAState s = 0; s < states; s++) {
+        const StateSet next = s + 1 < 64 ? (StateSet)1 << (s + 1) : 0;
+        if (builder.follow[s] & next) {
+            shiftMask |= next;
+        }
+        irregular[s] = builder.follow[s] & ~next;
+    }
+
+    for (unsigned int k = 0; k * 8 < states; k++) {
+        bool used = false;
+        for (unsigned int j = 0; j < 8 && k * 8 + j < states; j++) {
+            used = used || irregular[k * 8 + j] != 0;
+        }
+        if (!used) { continue; }
+
+        irregularChunks.push_back(k);
+        irregularFollow.resize(irregularChunks.size() * 256, 0);
+        StateSet *row = &irregularFollow[(irregularChunks.size() - 1) * 256];
+        for (unsigned int b = 1; b < 256; b++) {
+            // Reuse the row of `b` without its lowest bit.
+            const unsigned int j = __builtin_ctz(b);
+            row[b] = row[b & (b - 1)] | (k * 8 + j < states ? irregular[k * 8 + j] : 0);
+        }
+    }
+}
+
+ShiftAndNFA::ShiftAndNFA(const string& pattern, const unsigned int flags): ShiftAndNFA(RegexParser(pattern, flags).parse().simplified()) {}
+
+void ShiftAndNFA::receive(const FASymbol symbol)
+{
+    currentStates = symbol < ByteClasses::SymbolCount ? transitResult(currentStates, (unsigned char)symbol) : 0;
+}
+
+bool ShiftAndNFA::recognize(const string& str)
+{
+    StateSet states = 1;
+    for (auto it = str.begin(); it != str.end() && states != 0; it++) {
+        states = transitResult(states, (unsigned char)*it);
+    }
+    currentStates = states;
+    return (states & acceptMask) != 0;
+}
+
+vector<Substring> ShiftAndNFA::findRecognizedSubstrings(const string& str)
+{
+    resetCurrentStates();
+
+    const unsigned int NothingMatched = -1;
+
+    // `result` stores all matched substring,
+    vector<Substring> result;
+
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(str.data());
+    const unsigned char *end = begin + str.size();
+
+    // and `matchBegin` with `matchedLength` stores substring that is being analysed.
+    const unsigned char *matchBegin = begin;
+    unsigned int matchedLength = (acceptMask & 1) ? 0 : NothingMatched;
+
+    StateSet states = 1;
+    bool beginFromStartStates = false;
+
+    // Follow the symbol under analysed.
+    const unsigned char *parser = begin;
+
+    while (parser < end) {
+
+        states = transitResult(states, *parser);
+
+        if (states == 0) {
+
+            if (matchedLength != NothingMatched) {
+                result.push_back({(unsigned int)(matchBegin - begin), matchedLength});
+            }
+            if (beginFromStartStates) {
+                parser++;
+            }
+            beginFromStartStates = true;
+            states = 1;
+            matchBegin = parser;
+            matchedLength = NothingMatched;
+
+        } else {
+
+            beginFromStartStates = false;
+            parser++;
+            if (states & acceptMask) {
+                matchedLength = (unsigned int)(parser - matchBegin);
+            }
+        }
+    }
+
+    if (matchedLength != NothingMatched) {
+        result.push_back({(unsigned int)(matchBegin - begin), matchedLength});
+    }
+
+    return result;
+}
+
+void ShiftAndNFA::resetCurrentStates(void)
+{
+    currentStates = 1;
+}
@@ -0,0 +1,74 @@
+//
+//  ShiftAndNFA.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef ShiftAndNFA_hpp
+#define ShiftAndNFA_hpp
+
+#include <array>
+#include <cstdint>
+
+#include "FA.hpp"
+#include "ByteClasses.hpp"
+#include "RegexParser.hpp"
+
+namespace FAS
+{
+
+// A bit-parallel simulation of the position (Glushkov) automaton of a small regex. Every position is a bit of a 64-bit word, and bit 0 is the initial state.
+// All transitions into a position read the same class of symbols, so receiving a byte is `follow(current) & positionsOf[byte]`.
+// Transitions from position i to i + 1 are done by one shift for all positions, which makes a literal pattern pure Shift-And. Other transitions are looked up by 8 bits a time.
+class ShiftAndNFA: public FA
+{
+public:
+
+    static constexpr unsigned int MaxPositions = 63;
+
+private:
+
+    typedef uint64_t StateSet;
+
+    StateSet currentStates;
+    StateSet acceptMask; // Positions which may end a match, and bit 0 if the empty string is accepted.
+    StateSet shiftMask; // Positions i + 1 that follow i.
+    std::array<StateSet, ByteClasses::SymbolCount> positionsOf; // Positions reading a byte.
+
+    // Transitions which are not shifts. irregularFollow[k * 256 + b] is the union of the positions following every position 8k + j with bit j set in b.
+    // Only the chunks listed in `irregularChunks` have transitions like that.
+    vector<StateSet> irregularFollow;
+    vector<unsigned int> irregularChunks;
+
+    inline StateSet transitResult(const StateSet states, const unsigned char symbol) const
+    {
+        StateSet result = (states << 1) & shiftMask;
+        for (unsigned int k = 0; k < irregularChunks.size(); k++) {
+            result |= irregularFollow[(size_t)k * 256 + ((states >> (irregularChunks[k] * 8)) & 0xff)];
+        }
+        return result & positionsOf[symbol];
+    }
+
+    void resetCurrentStates(void);
+
+public:
+
+    // Count positions of `node` after expanding bounded repetitions, or `MaxPositions` + 1 if there are more than `MaxPositions`.
+    static unsigned int positionCount(const RegexNode& node);
+
+    // Throws `std::length_error` if `node` has more than `MaxPositions` positions, call `positionCount` first to choose another engine.
+    ShiftAndNFA(const RegexNode& node);
+    // Throws `RegexSyntaxError` if `pattern` is invalid, and `std::length_error` if it is too large.
+    ShiftAndNFA(const string& pattern, const unsigned int flags = NoFlags);
+
+    // Before using this, make sure the `currentStates` is what you need. Call `resetCurrentStates` if you want to begin from `startState`.
+    void receive(const FASymbol symbol) override;
+    bool recognize(const string& str) override;
+    vector<Substring> findRecognizedSubstrings(const string& str) override;
+
+};
+
+}
+
+#endif /* ShiftAndNFA_hpp */
@@ -0,0 +1,73 @@
+//
+//  SparseSet.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef SparseSet_hpp
+#define SparseSet_hpp
+
+#include "FA.hpp"
+
+namespace FAS
+{
+
+// A set of states in [0, capacity) with O(1) insert, lookup and clear, and no allocation once its capacity is reserved (Briggs & Torczon).
+// `dense`[0, count) holds the members in insertion order, and `sparse`[s] is the index of s in `dense` if s is a member.
+class SparseSet
+{
+private:
+
+    vector<FAState> dense;
+    vector<FAState> sparse;
+    FAState count = 0;
+
+public:
+
+    SparseSet(const FAState capacity = 0): dense(capacity), sparse(capacity) {}
+
+    // Make room for states in [0, capacity), members are kept.
+    void reserve(const FAState capacity)
+    {
+        if (capacity > sparse.size()) {
+            dense.resize(capacity);
+            sparse.resize(capacity);
+        }
+    }
+
+    bool contains(const FAState state) const
+    {
+        FAState index = sparse[state];
+        return index < count && dense[index] == state;
+    }
+
+    // Returns false if `state` is already a member.
+    bool insert(const FAState state)
+    {
+        if (contains(state)) { return false; }
+        dense[count] = state;
+        sparse[state] = count++;
+        return true;
+    }
+
+    // Make members the same as `s`, whose states must be less than the capacity.
+    void assign(const SparseSet& s)
+    {
+        clear();
+        for (FAState state : s) {
+            insert(state);
+        }
+    }
+
+    void clear(void) { count = 0; }
+    bool empty(void) const { return count == 0; }
+    FAState size(void) const { return count; }
+
+    vector<FAState>::const_iterator begin(void) const { return dense.begin(); }
+    vector<FAState>::const_iterator end(void) const { return dense.begin() + count; }
+};
+
+}
+
+#endif /* SparseSet_hpp */
@@ -0,0 +1,686 @@
+//
+//  StaticRegex.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef StaticRegex_hpp
+#define StaticRegex_hpp
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "FA.hpp"
+#include "RegexParser.hpp"
+
+namespace FAS
+{
+
+// A string literal as a template argument, like `StaticRegex<"a(b|c)*">`.
+template <size_t N>
+struct FixedString
+{
+    char chars[N] = {};
+
+    constexpr FixedString(const char (&s)[N])
+    {
+        for (size_t i = 0; i < N; i++) {
+            chars[i] = s[i];
+        }
+    }
+
+    constexpr size_t size(void) const { return N - 1; }
+    constexpr char operator[](const size_t i) const { return chars[i]; }
+};
+
+namespace StaticRegexDetail
+{
+
+// Everything here runs in constant evaluation, so it only uses fixed arrays, and limits are compile errors instead of allocations.
+constexpr unsigned int MaxPositions = 63; // Position 0 is the initial state, so a set of positions is one `uint64_t`.
+constexpr unsigned int MaxStates = 256;
+constexpr unsigned int MaxRepetition = 1000;
+constexpr unsigned int SymbolCount = 256;
+
+typedef uint64_t Positions;
+
+// Not constexpr, so reaching it stops compilation, and the diagnostic shows the call with its message.
+inline void fail(const char *message)
+{
+    throw std::invalid_argument(message);
+}
+
+struct ByteSet
+{
+    uint64_t words[4] = {};
+
+    constexpr void set(const unsigned int c) { words[c >> 6] |= (uint64_t)1 << (c & 63); }
+    constexpr bool test(const unsigned int c) const { return (words[c >> 6] >> (c & 63)) & 1; }
+    constexpr void merge(const ByteSet& s) { for (unsigned int i = 0; i < 4; i++) { words[i] |= s.words[i]; } }
+    constexpr void flip(void) { for (unsigned int i = 0; i < 4; i++) { words[i] = ~words[i]; } }
+
+    constexpr unsigned int count(void) const
+    {
+        unsigned int result = 0;
+        for (unsigned int c = 0; c < SymbolCount; c++) {
+            result += test(c);
+        }
+        return result;
+    }
+
+    constexpr unsigned int lowest(void) const
+    {
+        unsigned int c = 0;
+        while (c < SymbolCount && !test(c)) { c++; }
+        return c;
+    }
+};
+
+// A Glushkov automaton: every symbol class in the pattern is a position, and a position is entered only on its own symbols.
+struct Glushkov
+{
+    unsigned int positionCount = 1;
+    ByteSet symbols[MaxPositions + 1];
+    Positions follow[MaxPositions + 1] = {}; // follow[0] is where a match can begin.
+    Positions last = 0; // Positions where a match can end, with 0 if the empty string matches.
+};
+
+// What a subexpression contributes to the automaton.
+struct Fragment
+{
+    Positions first = 0;
+    Positions last = 0;
+    bool nullable = true;
+};
+
+// The same grammar as `RegexParser`, building a `Glushkov` automaton instead of a `RegexNode`.
+template <size_t N>
+struct Parser
+{
+    const FixedString<N>& pattern;
+    const unsigned int flags;
+    Glushkov& automaton;
+    size_t position = 0;
+
+    constexpr bool atEnd(void) const { return position >= pattern.size(); }
+    constexpr unsigned char peek(void) const { return pattern[position]; }
+
+    constexpr void link(const Positions from, const Positions to)
+    {
+        for (unsigned int p = 0; p <= MaxPositions; p++) {
+            if ((from >> p) & 1) {
+                automaton.follow[p] |= to;
+            }
+        }
+    }
+
+    constexpr Fragment concatenate(const Fragment& a, const Fragment& b)
+    {
+        link(a.last, b.first);
+        return {a.first | (a.nullable ? b.first : 0), b.last | (b.nullable ? a.last : 0), a.nullable && b.nullable};
+    }
+
+    constexpr Fragment parseAlternation(void)
+    {
+        Fragment result = parseConcatenation();
+        while (!atEnd() && peek() == '|') {
+            position++;
+            const Fragment f = parseConcatenation();
+            result = {result.first | f.first, result.last | f.last, result.nullable || f.nullable};
+        }
+        return result;
+    }
+
+    constexpr Fragment parseConcatenation(void)
+    {
+        Fragment result;
+        while (!atEnd() && peek() != '|' && peek() != ')') {
+            result = concatenate(result, parseRepetition());
+        }
+        return result;
+    }
+
+    constexpr Fragment parseRepetition(void)
+    {
+        const size_t atomBegin = position;
+        Fragment f = parseAtom();
+        while (!atEnd()) {
+            const size_t quantifierBegin = position;
+            unsigned int min = 0, max = 0;
+            bool unbounded = false;
+            switch (peek()) {
+                case '*': unbounded = true; position++; break;
+                case '+': min = 1; unbounded = true; position++; break;
+                case '?': max = 1; position++; break;
+                case '{':
+                    if (!parseBounds(min, max, unbounded)) { return f; }
+                    break;
+                default:
+                    return f;
+            }
+            f = repeat(f, atomBegin, quantifierBegin, min, max, unbounded);
+        }
+        return f;
+    }
+
+    // `f` is parsed from [`atomBegin`, `quantifierBegin`). Every repetition needs its own positions, so copies of `f` are parsed again from the same text.
+    constexpr Fragment repeat(const Fragment& f, const size_t atomBegin, const size_t quantifierBegin, const unsigned int min, const unsigned int max, const bool unbounded)
+    {
+        const size_t quantifierEnd = position;
+        bool used = false;
+        auto copy = [&]() {
+            if (!used) {
+                used = true;
+                return f;
+            }
+            position = atomBegin;
+            Fragment c = parseAtom();
+            while (position < quantifierBegin) {
+                const size_t begin = position;
+                unsigned int innerMin = 0, innerMax = 0;
+                bool innerUnbounded = false;
+                switch (peek()) {
+                    case '*': innerUnbounded = true; position++; break;
+                    case '+': innerMin = 1; innerUnbounded = true; position++; break;
+                    case '?': innerMax = 1; position++; break;
+                    default: parseBounds(innerMin, innerMax, innerUnbounded); break;
+                }
+                c = repeat(c, atomBegin, begin, innerMin, innerMax, innerUnbounded);
+            }
+            position = quantifierEnd;
+            return c;
+        };
+
+        Fragment result;
+        for (unsigned int i = 0; i < min; i++) {
+            result = concatenate(result, copy());
+        }
+        if (unbounded) {
+            Fragment c = copy();
+            link(c.last, c.first);
+            c.nullable = true;
+            result = concatenate(result, c);
+        } else {
+            for (unsigned int i = min; i < max; i++) {
+                Fragment c = copy();
+                c.nullable = true;
+                result = concatenate(result, c);
+            }
+        }
+        return result;
+    }
+
+    constexpr bool parseBounds(unsigned int& min, unsigned int& max, bool& unbounded)
+    {
+        size_t p = position + 1;
+        auto parseNumber = [&](unsigned int& number) {
+            const size_t begin = p;
+            number = 0;
+            while (p < pattern.size() && pattern[p] >= '0' && pattern[p] <= '9') {
+                number = number * 10 + (pattern[p++] - '0');
+                if (number > MaxRepetition) {
+                    fail("repetition bound exceeds 1000");
+                }
+            }
+            return p > begin;
+        };
+
+        if (!parseNumber(min)) { return false; }
+        max = min;
+        unbounded = false;
+        if (p < pattern.size() && pattern[p] == ',') {
+            p++;
+            unbounded = !parseNumber(max);
+        }
+        if (p >= pattern.size() || pattern[p] != '}') { return false; }
+        if (!unbounded && min > max) {
+            fail("repetition bounds out of order");
+        }
+        position = p + 1;
+        return true;
+    }
+
+    constexpr Fragment addPosition(const ByteSet& symbols)
+    {
+        if (automaton.positionCount > MaxPositions) {
+            fail("pattern has more than 63 positions for StaticRegex");
+        }
+        const unsigned int p = automaton.positionCount++;
+        automaton.symbols[p] = symbols;
+        return {(Positions)1 << p, (Positions)1 << p, false};
+    }
+
+    constexpr Fragment parseAtom(void)
+    {
+        const unsigned char c = peek();
+        ByteSet symbols;
+
+        switch (c) {
+
+            case '(': {
+                position++;
+                if (position + 1 < pattern.size() && pattern[position] == '?' && pattern[position + 1] == ':') {
+                    position += 2;
+                } else if (!atEnd() && peek() == '?') {
+                    fail("unsupported group syntax");
+                }
+                const Fragment f = parseAlternation();
+                if (atEnd()) {
+                    fail("missing ')'");
+                }
+                position++;
+                return f;
+            }
+
+            case '[':
+                position++;
+                return addPosition(parseClass());
+
+            case '.':
+                position++;
+                symbols.flip();
+                if (!(flags & DotMatchesNewline)) {
+                    symbols.words['\n' >> 6] &= ~((uint64_t)1 << ('\n' & 63));
+                }
+                return addPosition(symbols);
+
+            case '\\':
+                position++;
+                parseEscape(symbols);
+                return addPosition(foldCase(symbols));
+
+            case '*':
+            case '+':
+            case '?':
+                fail("nothing to repeat");
+                return {};
+
+            case '^':
+            case '$':
+                fail("anchors are not supported");
+                return {};
+
+            default:
+                position++;
+                symbols.set(c);
+                return addPosition(foldCase(symbols));
+        }
+    }
+
+    constexpr ByteSet parseClass(void)
+    {
+        ByteSet symbols;
+        bool negated = false;
+        if (!atEnd() && peek() == '^') {
+            negated = true;
+            position++;
+        }
+
+        bool first = true;
+        while (true) {
+            if (atEnd()) {
+                fail("missing ']'");
+            }
+            if (peek() == ']' && !first) {
+                position++;
+                break;
+            }
+            first = false;
+
+            ByteSet item;
+            if (peek() == '\\') {
+                position++;
+                parseEscape(item);
+            } else {
+                item.set(peek());
+                position++;
+            }
+
+            if (item.count() == 1 && position + 1 < pattern.size() && peek() == '-' && pattern[position + 1] != ']') {
+                const unsigned int low = item.lowest();
+                position++;
+                ByteSet upper;
+                if (peek() == '\\') {
+                    position++;
+                    parseEscape(upper);
+                } else {
+                    upper.set(peek());
+                    position++;
+                }
+                if (upper.count() != 1) {
+                    fail("invalid range end");
+                }
+                const unsigned int high = upper.lowest();
+                if (low > high) {
+                    fail("range out of order");
+                }
+                for (unsigned int s = low; s <= high; s++) {
+                    item.set(s);
+                }
+            }
+            symbols.merge(item);
+        }
+
+        symbols = foldCase(symbols);
+        if (negated) {
+            symbols.flip();
+        }
+        return symbols;
+    }
+
+    constexpr void parseEscape(ByteSet& symbols)
+    {
+        if (atEnd()) {
+            fail("trailing '\\'");
+        }
+        auto hexValue = [](const unsigned char c) -> int {
+            if (c >= '0' && c <= '9') { return c - '0'; }
+            if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+            if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+            return -1;
+        };
+
+        const unsigned char c = peek();
+        position++;
+
+        ByteSet temp;
+        switch (c) {
+            case 'n': symbols.set('\n'); return;
+            case 'r': symbols.set('\r'); return;
+            case 't': symbols.set('\t'); return;
+            case 'f': symbols.set('\f'); return;
+            case 'v': symbols.set('\v'); return;
+            case 'a': symbols.set('\a'); return;
+            case 'e': symbols.set(0x1b); return;
+            case '0': symbols.set(0); return;
+
+            case 'x':
+                if (position + 2 > pattern.size() || hexValue(pattern[position]) < 0 || hexValue(pattern[position + 1]) < 0) {
+                    fail("invalid '\\x' escape");
+                }
+                symbols.set(hexValue(pattern[position]) * 16 + hexValue(pattern[position + 1]));
+                position += 2;
+                return;
+
+            case 'd':
+            case 'D':
+                for (unsigned int s = '0'; s <= '9'; s++) { temp.set(s); }
+                break;
+
+            case 'w':
+            case 'W':
+                for (unsigned int s = '0'; s <= '9'; s++) { temp.set(s); }
+                for (unsigned int s = 'a'; s <= 'z'; s++) { temp.set(s); temp.set(s - 'a' + 'A'); }
+                temp.set('_');
+                break;
+
+            case 's':
+            case 'S':
+                for (unsigned char s : {' ', '\t', '\n', '\r', '\f', '\v'}) { temp.set(s); }
+                break;
+
+            default:
+                if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+                    fail("unknown escape");
+                }
+                symbols.set(c);
+                return;
+        }
+
+        // An uppercase class escape is the complement of the lowercase one.
+        if (c >= 'A' && c <= 'Z') {
+            temp.flip();
+        }
+        symbols.merge(temp);
+    }
+
+    constexpr ByteSet foldCase(const ByteSet& symbols) const
+    {
+        if (!(flags & CaseInsensitive)) { return symbols; }
+
+        ByteSet result = symbols;
+        for (unsigned int s = 'a'; s <= 'z'; s++) {
+            const unsigned int upper = s - 'a' + 'A';
+            if (symbols.test(s) || symbols.test(upper)) {
+                result.set(s);
+                result.set(upper);
+            }
+        }
+        return result;
+    }
+};
+
+// A minimal DFA numbered like `DenseDFA`: 0 is the dead state, and accept states are [`firstAcceptState`, `states`).
+struct Automaton
+{
+    unsigned int states = 0;
+    unsigned int startState = 0;
+    unsigned int firstAcceptState = 0;
+    unsigned int classCount = 0;
+    std::array<unsigned char, SymbolCount> classOf = {};
+    std::array<uint16_t, MaxStates * SymbolCount> transition = {}; // transition[state * classCount + class]
+};
+
+template <size_t N>
+consteval Automaton compile(const FixedString<N>& pattern, const unsigned int flags)
+{
+    Glushkov g;
+    Parser<N> parser{pattern, flags, g};
+    const Fragment f = parser.parseAlternation();
+    if (!parser.atEnd()) {
+        fail("unmatched ')'");
+    }
+    g.follow[0] = f.first;
+    g.last = f.last | (f.nullable ? 1 : 0);
+
+    // Bytes entering the same positions are one class, since every state treats them the same.
+    Automaton result;
+    std::array<Positions, SymbolCount> classPositions = {};
+    for (unsigned int c = 0; c < SymbolCount; c++) {
+        Positions entered = 0;
+        for (unsigned int p = 1; p < g.positionCount; p++) {
+            if (g.symbols[p].test(c)) {
+                entered |= (Positions)1 << p;
+            }
+        }
+        unsigned int k = 0;
+        while (k < result.classCount && classPositions[k] != entered) { k++; }
+        if (k == result.classCount) {
+            classPositions[result.classCount++] = entered;
+        }
+        result.classOf[c] = (unsigned char)k;
+    }
+    const unsigned int classCount = result.classCount;
+
+    // Subset construction, state 0 is the empty set and state 1 is the initial position.
+    std::array<Positions, MaxStates> sets = {};
+    std::array<uint16_t, MaxStates * SymbolCount> transition = {};
+    unsigned int states = 2;
+    sets[0] = 0;
+    sets[1] = 1;
+    for (unsigned int s = 0; s < states; s++) {
+        Positions reachable = 0;
+        for (unsigned int p = 0; p < g.positionCount; p++) {
+            if ((sets[s] >> p) & 1) {
+                reachable |= g.follow[p];
+            }
+        }
+        for (unsigned int k = 0; k < classCount; k++) {
+            const Positions next = reachable & classPositions[k];
+            unsigned int t = 0;
+            while (t < states && sets[t] != next) { t++; }
+            if (t == states) {
+                if (states == MaxStates) {
+                    fail("pattern has more than 256 DFA states for StaticRegex");
+                }
+                sets[states++] = next;
+            }
+            transition[s * classCount + k] = (uint16_t)t;
+        }
+    }
+
+    // Moore's refinement, begun from accepting or not, until no group splits.
+    std::array<uint16_t, MaxStates> group = {};
+    unsigned int groupCount = 0;
+    for (unsigned int s = 0; s < states; s++) {
+        group[s] = (sets[s] & g.last) != 0;
+    }
+    while (true) {
+        std::array<uint16_t, MaxStates> newGroup = {};
+        std::array<uint16_t, MaxStates> representative = {};
+        unsigned int newGroupCount = 0;
+        for (unsigned int s = 0; s < states; s++) {
+            unsigned int i = 0;
+            for (; i < newGroupCount; i++) {
+                const unsigned int r = representative[i];
+                bool same = group[r] == group[s];
+                for (unsigned int k = 0; k < classCount && same; k++) {
+                    same = group[transition[r * classCount + k]] == group[transition[s * classCount + k]];
+                }
+                if (same) { break; }
+            }
+            if (i == newGroupCount) {
+                representative[newGroupCount++] = (uint16_t)s;
+            }
+            newGroup[s] = (uint16_t)i;
+        }
+        const bool stable = newGroupCount == groupCount;
+        group = newGroup;
+        groupCount = newGroupCount;
+        if (stable) { break; }
+    }
+
+    // Number groups like `DenseDFA`: the group of the empty set, which holds every state that can never accept, is 0, and accepting groups are last.
+    std::array<uint16_t, MaxStates> number = {};
+    std::array<bool, MaxStates> numbered = {};
+    std::array<bool, MaxStates> accepting = {};
+    for (unsigned int s = 0; s < states; s++) {
+        accepting[group[s]] = (sets[s] & g.last) != 0;
+    }
+    unsigned int index = 1;
+    number[group[0]] = 0;
+    numbered[group[0]] = true;
+    for (unsigned int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            result.firstAcceptState = index;
+        }
+        for (unsigned int s = 0; s < states; s++) {
+            if (!numbered[group[s]] && accepting[group[s]] == (pass == 1)) {
+                numbered[group[s]] = true;
+                number[group[s]] = (uint16_t)index++;
+            }
+        }
+    }
+
+    result.states = groupCount;
+    result.startState = number[group[1]];
+    for (unsigned int s = 0; s < states; s++) {
+        for (unsigned int k = 0; k < classCount; k++) {
+            result.transition[number[group[s]] * classCount + k] = number[group[transition[s * classCount + k]]];
+        }
+    }
+    return result;
+}
+
+}
+
+// A regex compiled while compiling the program: `Pattern` is parsed, determinized and minimized in constant evaluation into `std::array` tables, so there is no startup cost and no heap memory.
+// It has the grammar of `RegexParser` and the matching semantics of `DenseDFA`, and an invalid pattern is a compile error. Patterns are limited to 63 symbol positions and 256 DFA states.
+//
+//     static_assert(StaticRegex<"[a-z]+@[a-z]+">::recognize("me@example"));
+template <FixedString Pattern, unsigned int Flags = NoFlags>
+class StaticRegex
+{
+private:
+
+    static constexpr StaticRegexDetail::Automaton automaton = StaticRegexDetail::compile(Pattern, Flags);
+
+public:
+
+    static constexpr FAState DeadState = 0;
+    static constexpr FAState States = automaton.states;
+    static constexpr FAState StartState = automaton.startState;
+    static constexpr FAState FirstAcceptState = automaton.firstAcceptState;
+    static constexpr unsigned int ClassCount = automaton.classCount;
+
+private:
+
+    static constexpr std::array<unsigned char, StaticRegexDetail::SymbolCount> classOf = automaton.classOf;
+
+    // Only the used part of `automaton`, with one byte for a state.
+    static constexpr std::array<uint8_t, States * ClassCount> table = []() {
+        std::array<uint8_t, States * ClassCount> result = {};
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = (uint8_t)automaton.transition[i];
+        }
+        return result;
+    }();
+
+    static constexpr FAState next(const FAState state, const unsigned char symbol)
+    {
+        return table[state * ClassCount + classOf[symbol]];
+    }
+
+public:
+
+    static constexpr bool recognize(const std::string_view str)
+    {
+        FAState state = StartState;
+        for (const char c : str) {
+            state = next(state, (unsigned char)c);
+            if (state == DeadState) { return false; }
+        }
+        return state >= FirstAcceptState;
+    }
+
+    // Same as `DenseDFA::findRecognizedSubstrings`.
+    static vector<Substring> findRecognizedSubstrings(const std::string_view str)
+    {
+        const unsigned int NothingMatched = -1;
+
+        vector<Substring> result;
+        if (StartState == DeadState) { return result; }
+
+        unsigned int matchBegin = 0;
+        unsigned int matchedLength = StartState >= FirstAcceptState ? 0 : NothingMatched;
+        FAState state = StartState;
+        bool beginFromStartState = false;
+
+        unsigned int parser = 0;
+        while (parser < str.size()) {
+            const FAState next = StaticRegex::next(state, (unsigned char)str[parser]);
+            if (next == DeadState) {
+                if (matchedLength != NothingMatched) {
+                    result.push_back({matchBegin, matchedLength});
+                }
+                if (beginFromStartState) {
+                    parser++;
+                }
+                beginFromStartState = true;
+                state = StartState;
+                matchBegin = parser;
+                matchedLength = NothingMatched;
+            } else {
+                beginFromStartState = false;
+                parser++;
+                state = next;
+                if (state >= FirstAcceptState) {
+                    matchedLength = parser - matchBegin;
+                }
+            }
+        }
+
+        if (matchedLength != NothingMatched) {
+            result.push_back({matchBegin, matchedLength});
+        }
+        return result;
+    }
+
+};
+
+}
+
+#endif /* StaticRegex_hpp */
@@ -0,0 +1,113 @@
+//
+//  StreamMatcher.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include "StreamMatcher.hpp"
+
+using namespace FAS;
+
+StreamMatcher::StreamMatcher(const DenseDFA& dfa): dfa(dfa)
+{
+    reset();
+}
+
+void StreamMatcher::reset(void)
+{
+    state = dfa.startState;
+    position = 0;
+    matchBegin = 0;
+    // Only the beginning of the stream is considered for the empty string.
+    matchedLength = dfa.startState != DenseDFA::DeadState && dfa.startState >= dfa.firstAcceptState ? 0 : NothingMatched;
+    beginFromStartState = false;
+}
+
+template <typename T>
+void StreamMatcher::feed(const T *rows, const unsigned char *data, const size_t size, vector<StreamSubstring>& result)
+{
+    // Same as `DenseDFA::findRecognizedSubstrings`, except that positions are offsets in the stream, and a restart always happens inside the current chunk at the byte where an attempt died.
+    // The prefilter is not used, since an occurrence of its literal may cross the end of the chunk.
+    const unsigned char *end = data + size;
+    const unsigned char *parser = data;
+    const uint64_t base = position;
+
+    auto accelerate = [&]() {
+        const unsigned char *stop = dfa.skipLoops(state, parser, end);
+        if (stop != parser) {
+            parser = stop;
+            beginFromStartState = false;
+            if (state >= dfa.firstAcceptState) {
+                matchedLength = base + (parser - data) - matchBegin;
+            }
+        }
+    };
+    accelerate();
+
+    while (parser < end) {
+
+        const FAState next = rows[(size_t)state * dfa.alphabetSize + dfa.byteClasses.classOf(*parser)];
+
+        if (next == DenseDFA::DeadState) {
+
+            if (matchedLength != NothingMatched) {
+                result.push_back({matchBegin, matchedLength});
+            }
+            if (beginFromStartState) {
+                parser++;
+            }
+            beginFromStartState = true;
+            state = dfa.startState;
+            matchBegin = base + (parser - data);
+            matchedLength = NothingMatched;
+            accelerate();
+
+        } else {
+
+            beginFromStartState = false;
+            parser++;
+            if (next >= dfa.firstAcceptState) {
+                matchedLength = base + (parser - data) - matchBegin;
+            }
+            if (next != state) {
+                state = next;
+                accelerate();
+            }
+        }
+    }
+
+    position = base + size;
+}
+
+vector<StreamSubstring> StreamMatcher::feed(const char *data, const size_t size)
+{
+    vector<StreamSubstring> result;
+    if (dfa.startState == DenseDFA::DeadState) {
+        position += size;
+        return result;
+    }
+
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    switch (dfa.stateWidth) {
+        case 1: feed(reinterpret_cast<const uint8_t *>(dfa.table), bytes, size, result); break;
+        case 2: feed(reinterpret_cast<const uint16_t *>(dfa.table), bytes, size, result); break;
+        default: feed(reinterpret_cast<const uint32_t *>(dfa.table), bytes, size, result); break;
+    }
+    return result;
+}
+
+vector<StreamSubstring> StreamMatcher::feed(const std::string_view chunk)
+{
+    return feed(chunk.data(), chunk.size());
+}
+
+vector<StreamSubstring> StreamMatcher::finish(void)
+{
+    vector<StreamSubstring> result;
+    if (matchedLength != NothingMatched) {
+        result.push_back({matchBegin, matchedLength});
+    }
+    reset();
+    return result;
+}
@@ -0,0 +1,55 @@
+//
+//  StreamMatcher.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef StreamMatcher_hpp
+#define StreamMatcher_hpp
+
+#include <cstdint>
+
+#include "DenseDFA.hpp"
+
+namespace FAS
+{
+
+// Finds matches of a `DenseDFA` in a stream received in chunks of any size, with the same results as `findRecognizedSubstrings` of the whole stream.
+// The automaton state and the match in progress are kept between chunks, so nothing is buffered and the input is never copied. `dfa` must outlive the matcher.
+class StreamMatcher
+{
+private:
+
+    static constexpr uint64_t NothingMatched = UINT64_MAX;
+
+    const DenseDFA& dfa;
+
+    FAState state;
+    uint64_t position; // Offset of the next byte to receive.
+    uint64_t matchBegin; // Offset of the substring that is being analysed,
+    uint64_t matchedLength; // and the length of its longest match so far, or `NothingMatched`.
+    bool beginFromStartState;
+
+    template <typename T>
+    void feed(const T *rows, const unsigned char *data, const size_t size, vector<StreamSubstring>& result);
+
+public:
+
+    StreamMatcher(const DenseDFA& dfa);
+
+    // Scan the next `size` bytes of the stream, and return matches which are complete. A match reaching the end of the chunk may still grow, so it is returned later.
+    vector<StreamSubstring> feed(const char *data, const size_t size);
+    vector<StreamSubstring> feed(std::string_view chunk);
+    // End the stream, and return the match in progress if there is one. The matcher is reset for a new stream.
+    vector<StreamSubstring> finish(void);
+
+    void reset(void);
+
+    uint64_t receivedBytes(void) const { return position; }
+
+};
+
+}
+
+#endif /* StreamMatcher_hpp */
@@ -0,0 +1,106 @@
+//
+//  SubsetArena.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef SubsetArena_hpp
+#define SubsetArena_hpp
+
+#include <algorithm>
+#include <cstdint>
+
+#include "HashValue.h"
+#include "FA.hpp"
+#include "ConstructionArena.hpp"
+
+namespace FAS
+{
+
+// Distinct sets of states, each stored once and numbered in the order they are interned, so a subset is known by its id alone.
+// Members of all subsets are packed into one arena, so a subset costs its sorted members and two words, and never allocates on its own.
+class SubsetArena
+{
+private:
+
+    static constexpr FAState EmptySlot = StateNotFound;
+
+    ArenaVector<FAState> members; // members[offsets[id], offsets[id + 1]) are the states of `id`.
+    ArenaVector<size_t> offsets = {0};
+    ArenaVector<size_t> hashes; // hashes[id], kept for growing `slots`.
+    ArenaVector<FAState> slots; // An id or `EmptySlot`, found by linear probing from the hash. Its size is a power of 2, at least twice the count of subsets.
+
+    // `hash_combine` over ids, which hash to themselves, leaves the low bits of similar subsets alike, and `slots` is indexed by the low bits only.
+    // So the seed is finished like MurmurHash3's fmix64, which makes every bit depend on every member.
+    static size_t hashOf(const ArenaVector<FAState>& states)
+    {
+        size_t seed = states.size();
+        for (const FAState s : states) {
+            hash_combine(seed, s);
+        }
+        uint64_t hash = seed;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb53fe1a85ec3ull;
+        hash ^= hash >> 33;
+        return (size_t)hash;
+    }
+
+    bool equals(const FAState id, const ArenaVector<FAState>& states) const
+    {
+        return offsets[id + 1] - offsets[id] == states.size() && std::equal(states.begin(), states.end(), members.begin() + offsets[id]);
+    }
+
+    void grow(void)
+    {
+        slots.assign(slots.size() * 2, EmptySlot);
+        const size_t mask = slots.size() - 1;
+        for (FAState id = 0; id < hashes.size(); id++) {
+            size_t i = hashes[id] & mask;
+            while (slots[i] != EmptySlot) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = id;
+        }
+    }
+
+public:
+
+    SubsetArena(): slots(16, EmptySlot) {}
+
+    // `states` must be sorted. Returns the id of `states`, and true if it is new.
+    pair<FAState, bool> intern(const ArenaVector<FAState>& states)
+    {
+        const size_t hash = hashOf(states);
+        const size_t mask = slots.size() - 1;
+        size_t i = hash & mask;
+        while (slots[i] != EmptySlot) {
+            if (hashes[slots[i]] == hash && equals(slots[i], states)) {
+                return {slots[i], false};
+            }
+            i = (i + 1) & mask;
+        }
+
+        const FAState id = size();
+        slots[i] = id;
+        hashes.push_back(hash);
+        members.insert(members.end(), states.begin(), states.end());
+        offsets.push_back(members.size());
+        if (hashes.size() * 2 > slots.size()) {
+            grow();
+        }
+        return {id, true};
+    }
+
+    FAState size(void) const { return (FAState)hashes.size(); }
+
+    // Members of `id`, which are moved by the next `intern`.
+    ArenaVector<FAState>::const_iterator begin(const FAState id) const { return members.begin() + offsets[id]; }
+    ArenaVector<FAState>::const_iterator end(const FAState id) const { return members.begin() + offsets[id + 1]; }
+};
+
+}
+
+#endif /* SubsetArena_hpp */
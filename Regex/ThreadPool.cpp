@@ -0,0 +1,88 @@
+//
+//  ThreadPool.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#include <algorithm>
+#include <exception>
+
+#include "ThreadPool.hpp"
+
+using namespace FAS;
+
+ThreadPool::ThreadPool(const unsigned int threadCount): stopping(false)
+{
+    for (unsigned int i = 0; i < std::max(threadCount, 1u); i++) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::work(void)
+{
+    while (true) {
+        std::function<void(void)> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) { return; }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::run(const size_t count, const std::function<void(size_t)>& task)
+{
+    // What the tasks of this call share, so calls from other threads wait only for their own tasks.
+    struct Batch
+    {
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t remaining;
+        std::exception_ptr exception;
+    } batch;
+    batch.remaining = count;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; i++) {
+            tasks.push([&batch, &task, i]() {
+                std::exception_ptr exception;
+                try {
+                    task(i);
+                } catch (...) {
+                    exception = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(batch.mutex);
+                if (exception && !batch.exception) {
+                    batch.exception = exception;
+                }
+                if (--batch.remaining == 0) {
+                    batch.finished.notify_one();
+                }
+            });
+        }
+    }
+    available.notify_all();
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.finished.wait(lock, [&batch]() { return batch.remaining == 0; });
+    if (batch.exception) {
+        std::rethrow_exception(batch.exception);
+    }
+}
@@ -0,0 +1,54 @@
+//
+//  ThreadPool.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "FA.hpp"
+
+namespace FAS
+{
+
+// A fixed set of worker threads, so work split into tasks does not create a thread for every task.
+class ThreadPool
+{
+private:
+
+    vector<std::thread> workers;
+    std::queue<std::function<void(void)>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void work(void);
+
+public:
+
+    // `threadCount` of 0 is taken as 1.
+    ThreadPool(const unsigned int threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run `task(0)`, ..., `task(count - 1)` on the workers, and return when all of them are done. If some throw, the first exception is thrown again here.
+    // It may be called from several threads at the same time, but not from a task.
+    void run(const size_t count, const std::function<void(size_t)>& task);
+
+    unsigned int size(void) const { return (unsigned int)workers.size(); }
+
+};
+
+}
+
+#endif /* ThreadPool_hpp */
@@ -11,6 +11,7 @@
 #include "BitNumber.hpp"
 #include "NFA.hpp"
 #include "DFA.hpp"
+#include "PatternCache.hpp"
 
 using namespace FAS;
 
@@ -23,10 +24,9 @@ class Solution {
 public:
     bool isMatch(string s, string p) {
 
-        NFA n = NFA(p);
-        vector<Substring> res = n.findRecognizedSubstrings(s);
-
-        return !res.empty() && res[0].second == s.size();
+        // The same patterns come again and again, so they are compiled only once.
+        static PatternCache cache;
+        return cache.get(p)->recognize(s.data(), s.size());
     }
 };
 
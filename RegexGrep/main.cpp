@@ -0,0 +1,357 @@
+//
+//  main.cpp
+//  RegexGrep
+//
+//  Created by Min on 2026/10/18.
+//
+
+// A grep-style scanner on top of `DenseDFA`. Input files are memory-mapped and scanned without copying, and directories are searched recursively.
+//
+//     RegexGrep [-i] [-n] [-c] [-b] [-l] [-q] [-t] pattern [file|directory ...]
+//
+//     -i  match letters of both cases
+//     -n  prefix lines with their line numbers
+//     -c  print the count of matching lines of each file instead of lines
+//     -b  print "offset:length" of every non-empty leftmost-longest match instead of lines
+//     -l  print only names of files with a match
+//     -q  print nothing, only set the exit status
+//     -t  report bytes scanned, time and throughput in MB/s to stderr
+//
+// Exits with 0 if any line matched, 1 if none did, and 2 on errors.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "NFA.hpp"
+#include "DFA.hpp"
+#include "DenseDFA.hpp"
+#include "LeftmostLongestMatcher.hpp"
+#include "RegexParser.hpp"
+#include "ConstructionArena.hpp"
+
+using namespace FAS;
+
+namespace
+{
+
+struct Options
+{
+    unsigned int flags = NoFlags;
+    bool lineNumbers = false;
+    bool countOnly = false;
+    bool byteOffsets = false;
+    bool filesOnly = false;
+    bool quiet = false;
+    bool statistics = false;
+    bool showFileNames = false;
+};
+
+// Matches are made line by line, so '\n' is removed from every class. Then '\n' kills every live state, a scan restarts after each line, and no match crosses one.
+void removeNewline(RegexNode& node)
+{
+    node.symbols.reset('\n');
+    for (auto& child : node.children) {
+        removeNewline(child);
+    }
+}
+
+// A file mapped read-only. Pipes and other files that can not be mapped are read into `buffer` instead.
+class MappedFile
+{
+private:
+
+    int descriptor = -1;
+    bool mapped = false;
+    string buffer;
+
+public:
+
+    const char *data = "";
+    size_t size = 0;
+    bool failed = false;
+
+    MappedFile(const string& path)
+    {
+        descriptor = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (descriptor < 0 || fstat(descriptor, &info) != 0) {
+            failed = true;
+            return;
+        }
+
+        if (S_ISREG(info.st_mode)) {
+            size = (size_t)info.st_size;
+            if (size == 0) { return; }
+            void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(address);
+                mapped = true;
+                return;
+            }
+        }
+
+        char chunk[1 << 16];
+        ssize_t count;
+        while ((count = read(descriptor, chunk, sizeof(chunk))) > 0) {
+            buffer.append(chunk, count);
+        }
+        failed = count < 0;
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    ~MappedFile()
+    {
+        if (mapped) {
+            munmap(const_cast<char *>(data), size);
+        }
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+class Scanner
+{
+private:
+
+    // A file is scanned in windows ending at line ends, since `Substring` holds 32-bit offsets, and matches of a window are listed at once with `-b`. Restarting a scan after '\n' does not change its result.
+    static constexpr size_t WindowSize = (size_t)1 << 20;
+
+    const DenseDFA& dfa;
+    const LeftmostLongestMatcher *matcher; // Finds the matches of `dfa` with `-b`, and is nullptr otherwise, when `dfa` is of `[^\n]*pattern[^\n]*`.
+    const Options& options;
+    const bool everyLineMatches; // The pattern matches the empty string, so it matches every line.
+
+public:
+
+    uint64_t scannedBytes = 0;
+    bool anyMatched = false;
+
+    Scanner(const DenseDFA& dfa, const LeftmostLongestMatcher *matcher, const Options& options, const bool everyLineMatches): dfa(dfa), matcher(matcher), options(options), everyLineMatches(everyLineMatches) {}
+
+    // Returns false if `path` could not be read.
+    bool scanFile(const string& path)
+    {
+        MappedFile file(path);
+        if (file.failed) {
+            std::cerr << "RegexGrep: " << path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        scannedBytes += file.size;
+
+        const string prefix = options.showFileNames ? path + ":" : "";
+        const char *data = file.data;
+        const char *end = data + file.size;
+
+        uint64_t matchedLines = 0;
+        uint64_t lineNumber = 1; // Line number of `counted`.
+        const char *counted = data;
+        const char *printedUntil = data; // End of the last printed line, a line is printed once however many matches it has.
+
+        auto onMatch = [&](const char *position, const size_t length) {
+            // Every match is printed with `-b`, except empty ones like `grep -bo`, but lines are still what is counted.
+            if (options.byteOffsets && length > 0 && !options.quiet && !options.filesOnly && !options.countOnly) {
+                std::printf("%s%llu:%zu\n", prefix.c_str(), (unsigned long long)(position - data), length);
+            }
+            if (position < printedUntil) { return; }
+
+            const char *lineBegin = position;
+            while (lineBegin > data && lineBegin[-1] != '\n') { lineBegin--; }
+            const char *lineEnd = static_cast<const char *>(memchr(position, '\n', end - position));
+            lineEnd = lineEnd != nullptr ? lineEnd : end;
+            printedUntil = lineEnd + 1;
+            matchedLines++;
+
+            if (options.quiet || options.filesOnly || options.countOnly || options.byteOffsets) { return; }
+            if (options.lineNumbers) {
+                for (; counted < lineBegin; counted++) {
+                    const char *next = static_cast<const char *>(memchr(counted, '\n', lineBegin - counted));
+                    if (next == nullptr) { break; }
+                    lineNumber++;
+                    counted = next;
+                }
+                counted = lineBegin;
+                std::printf("%s%llu:", prefix.c_str(), (unsigned long long)lineNumber);
+            } else {
+                std::fputs(prefix.c_str(), stdout);
+            }
+            std::fwrite(lineBegin, 1, lineEnd - lineBegin, stdout);
+            std::fputc('\n', stdout);
+        };
+
+        if (everyLineMatches) {
+            for (const char *line = data; line < end; ) {
+                const char *lineEnd = static_cast<const char *>(memchr(line, '\n', end - line));
+                lineEnd = lineEnd != nullptr ? lineEnd : end;
+                onMatch(line, 0);
+                line = lineEnd + 1;
+            }
+        } else {
+            // A file is done at its first match if only whether it matches is printed.
+            const bool firstMatchOnly = options.quiet || options.filesOnly;
+            for (const char *window = data; window < end && !(firstMatchOnly && matchedLines > 0); ) {
+                const char *windowEnd = window + std::min(WindowSize, (size_t)(end - window));
+                if (windowEnd < end) {
+                    const char *lineEnd = static_cast<const char *>(memchr(windowEnd, '\n', end - windowEnd));
+                    windowEnd = lineEnd != nullptr ? lineEnd + 1 : end;
+                }
+                const std::string_view text(window, windowEnd - window);
+                if (matcher != nullptr) {
+                    for (const auto& match : matcher->findRecognizedSubstrings(text)) {
+                        onMatch(window + match.first, match.second);
+                        if (firstMatchOnly) { break; }
+                    }
+                } else {
+                    dfa.forEachMatch(text, [&](const Substring& match) {
+                        onMatch(window + match.first, match.second);
+                        return !firstMatchOnly;
+                    });
+                }
+                window = windowEnd;
+            }
+        }
+
+        if (matchedLines > 0) {
+            anyMatched = true;
+        }
+        if (!options.quiet) {
+            if (options.filesOnly) {
+                if (matchedLines > 0) {
+                    std::printf("%s\n", path.c_str());
+                }
+            } else if (options.countOnly) {
+                std::printf("%s%llu\n", prefix.c_str(), (unsigned long long)matchedLines);
+            }
+        }
+        return true;
+    }
+
+    // Scan a file, or every regular file under a directory.
+    bool scanPath(const string& path)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error)) {
+            return scanFile(path);
+        }
+        bool succeeded = true;
+        for (auto it = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file(error)) {
+                succeeded = scanFile(it->path().string()) && succeeded;
+            }
+        }
+        if (error) {
+            std::cerr << "RegexGrep: " << path << ": " << error.message() << std::endl;
+            succeeded = false;
+        }
+        return succeeded;
+    }
+};
+
+int usage(void)
+{
+    std::cerr << "usage: RegexGrep [-i] [-n] [-c] [-b] [-l] [-q] [-t] pattern [file|directory ...]" << std::endl;
+    return 2;
+}
+
+}
+
+int main(int argc, const char * argv[]) {
+
+    Options options;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        }
+        for (const char *c = argv[i] + 1; *c != '\0'; c++) {
+            switch (*c) {
+                case 'i': options.flags |= CaseInsensitive; break;
+                case 'n': options.lineNumbers = true; break;
+                case 'c': options.countOnly = true; break;
+                case 'b': options.byteOffsets = true; break;
+                case 'l': options.filesOnly = true; break;
+                case 'q': options.quiet = true; break;
+                case 't': options.statistics = true; break;
+                default: return usage();
+            }
+        }
+    }
+    if (i >= argc) {
+        return usage();
+    }
+
+    const string pattern = argv[i++];
+    vector<string> paths(argv + i, argv + argc);
+    if (paths.empty()) {
+        paths.push_back("/dev/stdin");
+    }
+    options.showFileNames = paths.size() > 1 || std::filesystem::is_directory(paths[0]);
+
+    auto compileBegin = std::chrono::steady_clock::now();
+    DenseDFA dfa;
+    try {
+        // The NFA and DFA are only steps to the dense table, so they are built in an arena released at once.
+        ConstructionArena arena;
+        RegexNode node = RegexParser(pattern, options.flags).parse();
+        removeNewline(node);
+        if (!options.byteOffsets) {
+            // A scan of the pattern alone restarts where an attempt died, so it misses a match beginning inside a failed attempt, like "aab" in "aaab".
+            // A scan of `[^\n]*pattern[^\n]*` instead matches whole lines which contain a match, and after the first match of a line it skips to the line end as an accelerated state.
+            SymbolSet line;
+            line.set().reset('\n');
+            vector<RegexNode> items;
+            items.push_back(RegexNode::makeRepetition(RegexNode::makeClass(line), 0, RegexNode::Unbounded));
+            items.push_back(std::move(node));
+            items.push_back(RegexNode::makeRepetition(RegexNode::makeClass(line), 0, RegexNode::Unbounded));
+            node = RegexNode::makeConcatenation(std::move(items));
+        }
+        dfa = DenseDFA(DFA(NFA(node.simplified())));
+    } catch (const RegexSyntaxError& e) {
+        std::cerr << "RegexGrep: " << e.what() << std::endl;
+        return 2;
+    }
+    // Offsets of `-b` are those of the matches themselves, which only a leftmost-longest search finds every one of.
+    std::optional<LeftmostLongestMatcher> matcher;
+    if (options.byteOffsets) {
+        matcher.emplace(dfa);
+    }
+    auto scanBegin = std::chrono::steady_clock::now();
+
+    // Offsets printed by `-b` need the matches themselves even if the empty string matches.
+    const bool printsOffsets = options.byteOffsets && !options.quiet && !options.filesOnly && !options.countOnly;
+    Scanner scanner(dfa, matcher ? &*matcher : nullptr, options, dfa.recognize("") && !printsOffsets);
+    bool succeeded = true;
+    for (const auto& path : paths) {
+        succeeded = scanner.scanPath(path) && succeeded;
+    }
+    std::fflush(stdout);
+
+    if (options.statistics) {
+        auto scanEnd = std::chrono::steady_clock::now();
+        double compileTime = std::chrono::duration<double, std::milli>(scanBegin - compileBegin).count();
+        double scanTime = std::chrono::duration<double, std::milli>(scanEnd - scanBegin).count();
+        double megabytes = scanner.scannedBytes / 1e6;
+        std::fprintf(stderr, "compiled in %.3f ms, scanned %.3f MB in %.3f ms, %.1f MB/s\n", compileTime, megabytes, scanTime, scanTime > 0 ? megabytes / (scanTime / 1000) : 0.0);
+    }
+
+    if (!succeeded) {
+        return 2;
+    }
+    return scanner.anyMatched ? 0 : 1;
+}
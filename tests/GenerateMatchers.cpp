@@ -0,0 +1,53 @@
+//
+//  GenerateMatchers.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+// Writes every pattern of `GeneratedPatterns` with `CodeGenerator` in both styles into one header, followed by `GeneratedMatchers`, a table of the generated functions.
+//
+//     GenerateMatchers header
+
+#include <fstream>
+#include <iostream>
+
+#include "NFA.hpp"
+#include "DFA.hpp"
+#include "CodeGenerator.hpp"
+#include "GeneratedPatterns.hpp"
+
+using namespace FAS;
+
+int main(int argc, const char * argv[])
+{
+    if (argc != 2) {
+        std::cerr << "usage: GenerateMatchers header" << std::endl;
+        return 2;
+    }
+
+    std::ofstream out(argv[1], std::ios::trunc);
+    string table;
+    for (size_t i = 0; i < GeneratedPatternCount; i++) {
+        CodeGenerator generator(DFA(NFA(string(GeneratedPatterns[i]))));
+        const string index = std::to_string(i);
+        generator.generate(out, "tables" + index, CodeGenerator::Tables);
+        generator.generate(out, "jumps" + index, CodeGenerator::Goto);
+        table += "    {" + index + ", tables" + index + "::recognize, tables" + index + "::find},\n";
+        table += "    {" + index + ", jumps" + index + "::recognize, jumps" + index + "::find},\n";
+    }
+
+    out << "struct GeneratedMatcher\n{\n";
+    out << "    size_t pattern; // Index in `GeneratedPatterns`.\n";
+    out << "    bool (*recognize)(const char *data, const size_t size);\n";
+    out << "    std::vector<std::pair<unsigned int, unsigned int>> (*find)(const char *data, const size_t size);\n";
+    out << "};\n\n";
+    out << "inline const GeneratedMatcher GeneratedMatchers[] = {\n" << table << "};\n";
+
+    out.close();
+    if (!out) {
+        std::cerr << "GenerateMatchers: failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+//
+//  GeneratedPatterns.hpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+#ifndef GeneratedPatterns_hpp
+#define GeneratedPatterns_hpp
+
+#include <cstddef>
+
+// Patterns written as C++ by `GenerateMatchers` while building, whose generated code is checked against `DenseDFA` by `GeneratedTests`.
+inline const char *const GeneratedPatterns[] = {
+    "a(b|c)*",
+    "(ab|a)(bc|c)?",
+    "(a|b)*abb",
+    "x*",
+    "[^a]+b",
+    "a{2,4}b?",
+    "(a|)b",
+    "[a-c]+@[a-c]+\\.x",
+    "(.|\\n)*", // Never reaches the dead state.
+};
+
+inline constexpr size_t GeneratedPatternCount = sizeof(GeneratedPatterns) / sizeof(GeneratedPatterns[0]);
+
+#endif /* GeneratedPatterns_hpp */
@@ -0,0 +1,47 @@
+//
+//  GeneratedTests.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+// Checks the code written by `CodeGenerator`, which is compiled here like any code using it, against `DenseDFA` of the same patterns.
+
+#include <iostream>
+#include <random>
+
+#include "NFA.hpp"
+#include "DFA.hpp"
+#include "DenseDFA.hpp"
+#include "GeneratedPatterns.hpp"
+#include "GeneratedMatchers.hpp"
+
+using namespace FAS;
+
+int main()
+{
+    std::mt19937 rng(1);
+    unsigned int failures = 0;
+
+    for (const auto& matcher : GeneratedMatchers) {
+        DenseDFA dense{DFA{NFA{string(GeneratedPatterns[matcher.pattern])}}};
+        for (int i = 0; i < 2000; i++) {
+            string text(rng() % 16, ' ');
+            for (char& c : text) {
+                c = "abcx.@\n"[rng() % 7];
+            }
+            if (matcher.recognize(text.data(), text.size()) != dense.recognize(text) || matcher.find(text.data(), text.size()) != dense.findRecognizedSubstrings(text)) {
+                if (failures++ < 20) {
+                    std::cout << "FAILED: generated " << GeneratedPatterns[matcher.pattern] << " on \"" << text << "\"" << std::endl;
+                }
+            }
+        }
+    }
+
+    if (failures > 0) {
+        std::cout << failures << " failed" << std::endl;
+        return 1;
+    }
+    std::cout << "passed" << std::endl;
+    return 0;
+}
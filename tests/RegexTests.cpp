@@ -0,0 +1,862 @@
+//
+//  RegexTests.cpp
+//  Regex
+//
+//  Created by Min on 2026/10/18.
+//
+
+// Differential tests of the engines, which share one grammar and one matching semantics, so each of them is checked against a reference on random patterns and inputs:
+// `std::regex` for the parser and for NFAs composed by hand, an `NFA` of the syntax tree as parsed for `recognize` and `findRecognizedSubstrings`, and a search trying every substring for `LeftmostLongestMatcher`.
+//
+//     RegexTests [seed]
+//
+// Prints the first failures, and exits with 1 if there was any.
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <regex>
+#include <set>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "NFA.hpp"
+#include "DFA.hpp"
+#include "DenseDFA.hpp"
+#include "LazyDFA.hpp"
+#include "ShiftAndNFA.hpp"
+#include "RegexSet.hpp"
+#include "StreamMatcher.hpp"
+#include "ParallelMatcher.hpp"
+#include "LeftmostLongestMatcher.hpp"
+#include "ThreadPool.hpp"
+#include "PatternCache.hpp"
+#include "StaticRegex.hpp"
+#include "ByteClasses.hpp"
+#include "Minimizer.hpp"
+#include "SparseSet.hpp"
+#include "BitNumber.hpp"
+#include "SubsetArena.hpp"
+#include "ConstructionArena.hpp"
+#include "ByteSearch.hpp"
+#include "RegexParser.hpp"
+
+using namespace FAS;
+
+// `StaticRegex` is compiled in constant evaluation, so these are checked by building the tests.
+static_assert(StaticRegex<"[a-z]+@[a-z]+\\.com">::recognize("me@example.com"));
+static_assert(!StaticRegex<"[a-z]+@[a-z]+\\.com">::recognize("me@example.org"));
+static_assert(StaticRegex<"(ab|a)(bc|c)?">::recognize("abc"));
+static_assert(StaticRegex<"a{2,4}b?">::recognize("aaab") && !StaticRegex<"a{2,4}b?">::recognize("aaaaa"));
+static_assert(StaticRegex<"hello [a-c]", CaseInsensitive>::recognize("HeLLo B"));
+static_assert(StaticRegex<"x*">::recognize(""));
+
+namespace
+{
+
+unsigned int failures = 0;
+
+void expect(const bool condition, const string& what)
+{
+    if (!condition && failures++ < 20) {
+        std::cout << "FAILED: " << what << std::endl;
+    }
+}
+
+// `s` with '\n' escaped, for messages.
+string escaped(const string& s)
+{
+    string result = "\"";
+    for (char c : s) {
+        result += c == '\n' ? "\\n" : string(1, c);
+    }
+    return result + "\"";
+}
+
+// A random pattern of `atoms`, nested at most `depth` levels.
+string randomPattern(std::mt19937& rng, const vector<string>& atoms, const int depth)
+{
+    auto inner = [&]() { return randomPattern(rng, atoms, depth - 1); };
+    switch (depth > 0 ? rng() % 8 : 0) {
+        case 0:
+        case 1: return atoms[rng() % atoms.size()];
+        case 2:
+        case 3: return inner() + inner();
+        case 4: return "(" + inner() + "|" + inner() + ")";
+        case 5: return "(" + inner() + ")" + string(1, "*+?"[rng() % 3]);
+        case 6: return "(" + inner() + "){" + std::to_string(rng() % 3) + "," + std::to_string(2 + rng() % 2) + "}";
+        default: return "(?:" + inner() + ")";
+    }
+}
+
+// A random expression nested at most `depth` levels, composed with `makeUnion`, `makeConcatenation` and `makeStar`, which splice with ε-transitions, and its pattern in the syntax of `std::regex`.
+// With `building`, every NFA is composed in building mode, and the caller finishes building the whole expression.
+// `nullable` is set if the expression matches the empty string, and such expressions are not starred, since `std::regex` backtracks on them without bound.
+pair<string, NFA> randomComposition(std::mt19937& rng, const int depth, const bool building, bool& nullable)
+{
+    if (depth == 0 || rng() % 4 == 0) {
+        const char symbol = "abc"[rng() % 3];
+        nullable = false;
+        return {string(1, symbol), NFA(symbol)};
+    }
+    auto [pattern, result] = randomComposition(rng, depth - 1, building, nullable);
+    if (building) {
+        result.beginBuilding();
+    }
+    bool otherNullable;
+    switch (rng() % 3) {
+        case 0: {
+            auto [other, n] = randomComposition(rng, depth - 1, building, otherNullable);
+            result.makeUnion(n);
+            nullable = nullable || otherNullable;
+            return {"(" + pattern + "|" + other + ")", result};
+        }
+        case 1: {
+            auto [other, n] = randomComposition(rng, depth - 1, building, otherNullable);
+            result.makeConcatenation(n);
+            nullable = nullable && otherNullable;
+            return {pattern + other, result};
+        }
+        default:
+            if (nullable) {
+                return {pattern, result};
+            }
+            result.makeStar();
+            nullable = true;
+            return {"(" + pattern + ")*", result};
+    }
+}
+
+string randomText(std::mt19937& rng, const string& alphabet, const size_t maxLength)
+{
+    string text(rng() % (maxLength + 1), ' ');
+    for (char& c : text) {
+        c = alphabet[rng() % alphabet.size()];
+    }
+    return text;
+}
+
+vector<Substring> toSubstrings(const vector<StreamSubstring>& matches)
+{
+    vector<Substring> result;
+    for (const auto& match : matches) {
+        result.push_back({(unsigned int)match.first, (unsigned int)match.second});
+    }
+    return result;
+}
+
+// Whether a repetition in `node` repeats a pattern matching the empty string, which `std::regex` backtracks on without bound.
+bool hasNullableRepetition(const RegexNode& node)
+{
+    if (node.type == RegexNodeType::Repetition && node.max > 1 && node.children[0].isNullable()) {
+        return true;
+    }
+    return std::any_of(node.children.begin(), node.children.end(), hasNullableRepetition);
+}
+
+string temporaryPath(const string& name)
+{
+    return (std::filesystem::temp_directory_path() / ("RegexTests-" + std::to_string(getpid()) + "-" + name)).string();
+}
+
+void testParser(std::mt19937& rng)
+{
+    const vector<string> patterns = {"a|b|c", "abc|abd|ab", "(ab)+c?", "a{2,4}b{3}", "[a-c]*x[^a]", "(a|ab)(c|bcd)(d*)", "\\d+\\.\\d*", "(?:ab|ac|ad)e", "a{0,3}", "(a*)*b", "x(a+)?y", "[\\]a]+", "[a-]b", "[\\w-]+@x", "a.c", "(foo|foobar|fo)o", "((a|b)*c){2}", "a{2,}", "b|", "\\x61+", "(a?){3}a{3}", "", "[^\\n]+"};
+    for (const auto& pattern : patterns) {
+        const std::regex reference(pattern.empty() ? "(?:)" : pattern);
+        NFA n(pattern);
+        for (int i = 0; i < 500; i++) {
+            const string text = randomText(rng, "abcdxy0.@-]\ne", 7);
+            expect(n.recognize(text) == std::regex_match(text, reference), "NFA(" + escaped(pattern) + ").recognize(" + escaped(text) + ")");
+        }
+    }
+
+    const vector<string> atoms = {"a", "b", "c", "[a-b]", "."};
+    for (int t = 0; t < 200; t++) {
+        const string pattern = randomPattern(rng, atoms, 4);
+        if (hasNullableRepetition(RegexParser(pattern).parse())) {
+            continue;
+        }
+        const std::regex reference(pattern);
+        NFA n(pattern);
+        for (int i = 0; i < 50; i++) {
+            const string text = randomText(rng, "abcd", 6);
+            expect(n.recognize(text) == std::regex_match(text, reference), "NFA(" + escaped(pattern) + ").recognize(" + escaped(text) + ")");
+        }
+    }
+
+    for (const string pattern : {"(a", "a)", "*a", "a{3,2}", "[a", "\\q", "a^", "\\x4", "a{1001}", "[b-a]", "(?=a)", "((ab|cd){1000}){1000}", "(a{1000}){101}", "(a{1000}){50}(b{1000}){51}"}) {
+        bool rejected = false;
+        try {
+            RegexParser(pattern).parse();
+        } catch (const RegexSyntaxError&) {
+            rejected = true;
+        }
+        expect(rejected, "RegexParser(" + escaped(pattern) + ") is rejected");
+    }
+
+    expect(RegexParser("(a{1000}){100}").parse().type == RegexNodeType::Repetition, "RegexParser of a pattern expanding to the limit");
+    // The parser keeps its own copy of the pattern.
+    RegexParser parser(string("ab") + "c");
+    expect(NFA(parser.parse()).recognize("abc"), "RegexParser of a temporary pattern");
+
+    NFA caseInsensitive("hello [a-c]", CaseInsensitive);
+    expect(caseInsensitive.recognize("HeLLo B") && !caseInsensitive.recognize("hello d"), "CaseInsensitive");
+    NFA dot("a.b", DotMatchesNewline);
+    expect(dot.recognize("a\nb") && !NFA("a.b").recognize("a\nb"), "DotMatchesNewline");
+}
+
+// Every engine against an `NFA` of the unsimplified syntax tree.
+void testEngines(std::mt19937& rng)
+{
+    const vector<string> atoms = {"a", "b", "c", "ab", "[^a]", "[a-b]", "[^\\n]*"};
+    for (int t = 0; t < 400; t++) {
+        const string pattern = t == 0 ? "" : randomPattern(rng, atoms, 4);
+        const RegexNode node = RegexParser(pattern).parse();
+        NFA reference(node);
+        NFA n(node.simplified());
+        DFA d(n);
+        DenseDFA dense(d);
+        LazyDFA lazy(n);
+        LazyDFA flushing(n, 600);
+        StreamMatcher stream(dense);
+        ParallelMatcher parallel(dense, 3);
+        const bool shiftAndFits = ShiftAndNFA::positionCount(node.simplified()) <= ShiftAndNFA::MaxPositions;
+        std::optional<ShiftAndNFA> shiftAnd;
+        if (shiftAndFits) {
+            shiftAnd.emplace(node.simplified());
+        }
+
+        for (int i = 0; i < 40; i++) {
+            const string text = randomText(rng, "abcd\n", 40);
+            const string what = "(" + escaped(pattern) + ", " + escaped(text) + ")";
+            const bool recognized = reference.recognize(text);
+            const vector<Substring> found = reference.findRecognizedSubstrings(text);
+
+            expect(n.recognize(text) == recognized && n.findRecognizedSubstrings(text) == found, "NFA" + what);
+            expect(d.recognize(text) == recognized && d.findRecognizedSubstrings(text) == found, "DFA" + what);
+            expect(dense.recognize(text) == recognized && dense.findRecognizedSubstrings(text) == found, "DenseDFA" + what);
+            const string buffer = "x\n" + text + "\nx";
+            expect(dense.findRecognizedSubstrings(buffer.data() + 2, text.size()) == found, "DenseDFA of a window of a buffer" + what);
+            expect(dense.findRecognizedSubstrings(std::string_view(buffer).substr(2, text.size())) == found, "DenseDFA of a string_view" + what);
+            expect(dense.count(text) == found.size() && dense.first(text) == (found.empty() ? std::nullopt : std::optional<Substring>(found[0])), "DenseDFA::count and first" + what);
+            vector<Substring> iterated, called;
+            for (const Substring& match : dense.matches(text)) {
+                iterated.push_back(match);
+            }
+            dense.forEachMatch(text, [&](const Substring& match) { called.push_back(match); return called.size() < 2; });
+            expect(iterated == found && called == vector<Substring>(found.begin(), found.begin() + std::min(found.size(), (size_t)2)), "DenseDFA::matches and forEachMatch" + what);
+            expect(lazy.recognize(text) == recognized && lazy.findRecognizedSubstrings(text) == found, "LazyDFA" + what);
+            expect(flushing.recognize(text) == recognized && flushing.findRecognizedSubstrings(text) == found, "LazyDFA with a small budget" + what);
+            if (shiftAnd) {
+                expect(shiftAnd->recognize(text) == recognized && shiftAnd->findRecognizedSubstrings(text) == found, "ShiftAndNFA" + what);
+            }
+            expect(parallel.recognize(text) == recognized && toSubstrings(parallel.findRecognizedSubstrings(text)) == found, "ParallelMatcher" + what);
+
+            // Chunks of random sizes, including empty ones.
+            vector<StreamSubstring> streamed;
+            for (size_t position = 0; position < text.size(); ) {
+                const size_t size = std::min<size_t>(rng() % 7, text.size() - position);
+                const auto matches = stream.feed(text.data() + position, size);
+                streamed.insert(streamed.end(), matches.begin(), matches.end());
+                position += size;
+            }
+            expect(stream.receivedBytes() == text.size(), "StreamMatcher::receivedBytes" + what);
+            const auto matches = stream.finish();
+            streamed.insert(streamed.end(), matches.begin(), matches.end());
+            expect(toSubstrings(streamed) == found && stream.receivedBytes() == 0, "StreamMatcher" + what);
+        }
+    }
+
+    // Buffers of several chunks, which are scanned by several threads.
+    // The last pattern has too many states to run a chunk from every state, so it is recognized sequentially.
+    for (const string pattern : {"ab[^\\n]*c", "(a|b)*abb", "[^a]+", "a(b|c)*d|ca", "(a|b)*a(a|b){6}"}) {
+        DenseDFA dense{DFA{NFA{pattern}}};
+        ParallelMatcher parallel(dense, 4);
+        const string text = randomText(rng, "abcd\n", 6 << 20);
+        expect(toSubstrings(parallel.findRecognizedSubstrings(text)) == dense.findRecognizedSubstrings(text), "ParallelMatcher(" + escaped(pattern) + ") of a large buffer");
+        expect(parallel.recognize(text) == dense.recognize(text) && parallel.recognize(text + "a") == dense.recognize(text + "a"), "ParallelMatcher(" + escaped(pattern) + ").recognize of a large buffer");
+    }
+
+    // Bounded repetitions are counted expanded, and a pattern of too many positions is refused.
+    const RegexNode large = RegexParser("(ab){31}c").parse();
+    expect(ShiftAndNFA::positionCount(large) == 63 && ShiftAndNFA::positionCount(RegexParser("(ab){32}").parse()) == 64, "ShiftAndNFA::positionCount");
+    ShiftAndNFA shiftAnd(large);
+    string repeated;
+    for (int i = 0; i < 31; i++) {
+        repeated += "ab";
+    }
+    expect(shiftAnd.recognize(repeated + "c") && !shiftAnd.recognize(repeated) && !shiftAnd.recognize(repeated + "abc"), "ShiftAndNFA of 63 positions");
+    bool refused = false;
+    try {
+        ShiftAndNFA("(ab){32}");
+    } catch (const std::length_error&) {
+        refused = true;
+    }
+    expect(refused, "ShiftAndNFA of 64 positions is refused");
+
+    // The DFA of a symbol 10 symbols from the end has over 1000 states, so a small cache is flushed, and at last simulates the NFA.
+    NFA n(".*a.........");
+    LazyDFA lazy(n, 4096);
+    string text(20000, 'a');
+    for (char& c : text) {
+        c = "ab"[rng() % 2];
+    }
+    expect(lazy.findRecognizedSubstrings(text) == n.findRecognizedSubstrings(text) && lazy.flushCount() > 0, "LazyDFA flushing its cache");
+}
+
+// Every match contains the required literal, and scans skipped by it find the same matches as an `NFA`, which reads every byte.
+void testPrefilter(std::mt19937& rng)
+{
+    const vector<pair<string, RequiredLiteral>> literals = {{"error: [a-z]+", {"error: ", true}}, {"[a-z]+foo[0-9]", {"foo", false}}, {"a|b", {"", false}}, {"(abc|abd)x", {"ab", true}}, {"x*hello(world)?", {"hello", false}}};
+    for (const auto& [pattern, literal] : literals) {
+        const RequiredLiteral required = RegexParser(pattern).parse().requiredLiteral();
+        expect(required.literal == literal.literal && required.isPrefix == literal.isPrefix, "RegexNode::requiredLiteral of " + escaped(pattern));
+    }
+
+    const vector<string> atoms = {"ab", "abab", "aab", "x", "[^\\n]", "[a-b]*", "\\n"};
+    for (int t = 0; t < 200; t++) {
+        const string pattern = randomPattern(rng, atoms, 3);
+        const RegexNode node = RegexParser(pattern).parse();
+        const RequiredLiteral required = node.requiredLiteral();
+        NFA reference(node);
+        DFA d{NFA{pattern}};
+        DenseDFA dense(d);
+        for (int i = 0; i < 10; i++) {
+            const string text = randomText(rng, "aabbx\ny", 400);
+            const string what = "(" + escaped(pattern) + ", " + escaped(text) + ")";
+            const vector<Substring> found = reference.findRecognizedSubstrings(text);
+            for (const auto& match : found) {
+                const string matched = text.substr(match.first, match.second);
+                expect(matched.find(required.literal) != string::npos && (!required.isPrefix || matched.starts_with(required.literal)), "RegexNode::requiredLiteral" + what);
+            }
+            expect(d.findRecognizedSubstrings(text) == found, "DFA with a prefilter" + what);
+            expect(dense.findRecognizedSubstrings(text) == found, "DenseDFA with a prefilter" + what);
+        }
+    }
+}
+
+// States looping on all but a few bytes skip to the next of them, which must find the same matches as an `NFA`, which reads every byte.
+void testAcceleration(std::mt19937& rng)
+{
+    for (int t = 0; t < 2000; t++) {
+        const string text = randomText(rng, "abcdefgh", 100);
+        const size_t begin = rng() % (text.size() + 1);
+        const unsigned char bytes[] = {(unsigned char)('a' + rng() % 10), (unsigned char)('a' + rng() % 10), (unsigned char)('a' + rng() % 10)};
+        const unsigned int count = rng() % 4;
+        size_t expected = begin;
+        while (expected < text.size() && std::find(bytes, bytes + count, (unsigned char)text[expected]) == bytes + count) {
+            expected++;
+        }
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(text.data());
+        expect(findAnyByte(data + begin, data + text.size(), bytes, count) == data + expected, "findAnyByte of " + std::to_string(count) + " bytes in " + escaped(text));
+    }
+
+    for (const string pattern : {"[^\\n]*\\n", "a[^x]*x", "\"[^\"]*\"", "[^ab]*[ab]b", "b.*", "(a[^xy\\n]*[xy])+", "(.|\\n)*c"}) {
+        NFA reference(pattern);
+        DenseDFA dense{DFA{reference}};
+        for (int i = 0; i < 20; i++) {
+            const string text = randomText(rng, "abcdefghijklmnop\"xyabcdefghijklmnop", 2000) + randomText(rng, "\n", 2);
+            expect(dense.recognize(text) == reference.recognize(text) && dense.findRecognizedSubstrings(text) == reference.findRecognizedSubstrings(text), "DenseDFA(" + escaped(pattern) + ") with accelerated states");
+        }
+    }
+}
+
+// The matches of the whole set are those of the union of its patterns.
+void testRegexSet(std::mt19937& rng)
+{
+    const vector<string> atoms = {"a", "b", "c", "d", "[a-b]"};
+    for (int t = 0; t < 100; t++) {
+        vector<string> patterns;
+        string union_;
+        for (unsigned int id = 1 + rng() % 5; id > 0; id--) {
+            patterns.push_back(randomPattern(rng, atoms, 3));
+            union_ += (union_.empty() ? "(" : "|(") + patterns.back() + ")";
+        }
+        RegexSet set(patterns);
+        vector<NFA> alone;
+        vector<NFA> anywhere;
+        for (const auto& pattern : patterns) {
+            alone.emplace_back(pattern);
+            anywhere.emplace_back("(.|\n)*(" + pattern + ")(.|\n)*");
+        }
+        NFA all(union_);
+
+        for (int i = 0; i < 50; i++) {
+            const string text = randomText(rng, "abcd", 10);
+            vector<unsigned int> whole, inside;
+            for (unsigned int id = 0; id < patterns.size(); id++) {
+                if (alone[id].recognize(text)) { whole.push_back(id); }
+                if (anywhere[id].recognize(text)) { inside.push_back(id); }
+            }
+            const string what = "RegexSet(" + escaped(union_) + ", " + escaped(text) + ")";
+            expect(set.recognizedPatterns(text) == whole, what + ".recognizedPatterns");
+            expect(set.findRecognizedPatterns(text) == inside, what + ".findRecognizedPatterns");
+            expect(set.recognize(text) == all.recognize(text) && set.findRecognizedSubstrings(text) == all.findRecognizedSubstrings(text), what);
+        }
+    }
+
+    // The subsets of the last 20 symbols are more than `MaxStates`.
+    bool thrown = false;
+    try {
+        RegexSet({"x", "(a|b)*a(a|b){19}"});
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    expect(thrown, "RegexSet over MaxStates throws std::length_error");
+}
+
+// Automata of ε-transitions, composed eagerly and in building mode, against `std::regex`.
+void testComposition(std::mt19937& rng)
+{
+    for (int t = 0; t < 200; t++) {
+        std::mt19937 same = rng;
+        bool nullable;
+        auto [pattern, n] = randomComposition(rng, 4, false, nullable);
+        NFA built = randomComposition(same, 4, true, nullable).second;
+        built.finishBuilding();
+        const std::regex reference(pattern);
+        DFA d(n);
+        LazyDFA lazy(built);
+        for (int i = 0; i < 20; i++) {
+            const string text = randomText(rng, "abcd", 12);
+            const string what = "(" + escaped(pattern) + ", " + escaped(text) + ")";
+            const bool recognized = std::regex_match(text, reference);
+            const vector<Substring> found = d.findRecognizedSubstrings(text);
+            expect(n.recognize(text) == recognized && n.findRecognizedSubstrings(text) == found, "NFA composed" + what);
+            expect(built.recognize(text) == recognized && built.findRecognizedSubstrings(text) == found, "NFA composed in building mode" + what);
+            expect(d.recognize(text) == recognized, "DFA composed" + what);
+            expect(lazy.recognize(text) == recognized && lazy.findRecognizedSubstrings(text) == found, "LazyDFA composed" + what);
+        }
+    }
+}
+
+void testByteClasses(void)
+{
+    // Classes are numbered in order of their smallest symbol.
+    ByteClasses classes;
+    vector<unsigned int> labels(ByteClasses::SymbolCount, 0);
+    labels['a'] = labels['b'] = 1;
+    labels['c'] = 2;
+    classes.refine(labels);
+    expect(classes.classCount() == 3 && classes.classOf('a') == 1 && classes.classOf('b') == 1 && classes.classOf('c') == 2 && classes.classOf(0xe9) == 0, "ByteClasses::refine");
+    expect(classes.representatives() == vector<FASymbol>{0, 'a', 'c'}, "ByteClasses::representatives");
+    labels['b'] = 2;
+    classes.refine(labels);
+    expect(classes.classCount() == 4 && classes.classOf('a') != classes.classOf('b') && classes.classOf('b') != classes.classOf('c'), "ByteClasses::refine of refined classes");
+
+    // Symbols without a transition, and bytes out of `FA::symbols`, lead to a dead state.
+    DFA d(3, 0, {2}, {{{'a', 1}}, {{'b', 2}}, {}});
+    expect(d.recognize("ab") && !d.recognize("a") && !d.recognize("ac") && !d.recognize("a\xe9") && !d.recognize("abb"), "DFA with missing transitions");
+    expect(d.findRecognizedSubstrings("xab\xe9" "aab") == vector<Substring>{{1, 2}, {5, 2}}, "DFA::findRecognizedSubstrings with missing transitions");
+    DenseDFA dense(d);
+    expect(dense.recognize("ab") && !dense.recognize("a\xe9") && dense.findRecognizedSubstrings("xab\xe9" "aab") == vector<Substring>{{1, 2}, {5, 2}}, "DenseDFA with missing transitions");
+}
+
+// Groups of equivalent states found by refining until no group splits, numbered in order of their smallest state like `minimizeStates` does.
+ArenaVector<FAState> equivalentStates(const ArenaVector<ArenaVector<FAState>>& transition, ArenaVector<FAState> groups)
+{
+    for (size_t count = 0; ; ) {
+        std::map<vector<FAState>, FAState> numbers;
+        ArenaVector<FAState> refined(groups.size());
+        for (FAState s = 0; s < groups.size(); s++) {
+            vector<FAState> signature = {groups[s]};
+            for (FAState next : transition[s]) {
+                signature.push_back(groups[next]);
+            }
+            refined[s] = numbers.emplace(signature, (FAState)numbers.size()).first->second;
+        }
+        groups = refined;
+        if (numbers.size() == count) {
+            return groups;
+        }
+        count = numbers.size();
+    }
+}
+
+void testMinimizer(std::mt19937& rng)
+{
+    for (int t = 0; t < 200; t++) {
+        const FAState states = 1 + rng() % 40;
+        const FASymbol classCount = 1 + rng() % 4;
+        ArenaVector<ArenaVector<FAState>> transition(states, ArenaVector<FAState>(classCount));
+        ArenaVector<FAState> groups(states);
+        for (FAState s = 0; s < states; s++) {
+            for (auto& next : transition[s]) {
+                next = rng() % states;
+            }
+            groups[s] = rng() % 3 == 0 ? 1 : 0;
+        }
+        const ArenaVector<FAState> expected = equivalentStates(transition, groups);
+        const FAState count = minimizeStates(transition, classCount, groups);
+        expect(groups == expected && count == *std::max_element(expected.begin(), expected.end()) + 1, "minimizeStates of a random DFA with " + std::to_string(states) + " states");
+    }
+
+    // Counting symbols modulo 12 and accepting multiples of 4 only needs 4 states.
+    ArenaVector<ArenaVector<FAState>> transition(12);
+    ArenaVector<FAState> groups(12);
+    for (FAState s = 0; s < 12; s++) {
+        transition[s] = {(s + 1) % 12};
+        groups[s] = s % 4 == 0 ? 1 : 0;
+    }
+    expect(minimizeStates(transition, 1, groups) == 4 && groups[5] == 1 && groups[9] == 1, "minimizeStates of a counter");
+}
+
+// Members in insertion order, after random inserts and clears, against `std::set`.
+void testSparseSet(std::mt19937& rng)
+{
+    SparseSet set(8);
+    std::set<FAState> reference;
+    vector<FAState> order;
+    for (int i = 0; i < 5000; i++) {
+        const FAState state = rng() % 64;
+        set.reserve(state + 1);
+        switch (rng() % 8) {
+            case 0:
+                set.clear();
+                reference.clear();
+                order.clear();
+                break;
+            case 1: {
+                SparseSet copy(64);
+                copy.assign(set);
+                expect(vector<FAState>(copy.begin(), copy.end()) == order, "SparseSet::assign");
+                break;
+            }
+            default:
+                expect(set.insert(state) == reference.insert(state).second, "SparseSet::insert(" + std::to_string(state) + ")");
+                if (order.size() < reference.size()) {
+                    order.push_back(state);
+                }
+                break;
+        }
+        expect(set.size() == reference.size() && set.empty() == reference.empty() && vector<FAState>(set.begin(), set.end()) == order, "SparseSet members");
+        expect(set.contains(state) == reference.contains(state), "SparseSet::contains(" + std::to_string(state) + ")");
+    }
+}
+
+void testBitNumber(std::mt19937& rng)
+{
+    // Random sets set and cleared one position at a time, kept beside a `std::set` of the same positions.
+    for (int t = 0; t < 300; t++) {
+        const unsigned int range = t % 2 == 0 ? 200 : 1000; // Inline, or on the heap.
+        std::set<unsigned int> a, b;
+        BitNumber x, y;
+        for (int i = 0; i < 200; i++) {
+            const unsigned int position = rng() % range;
+            std::set<unsigned int>& positions = rng() % 2 ? a : b;
+            BitNumber& number = &positions == &a ? x : y;
+            if (rng() % 3 == 0) {
+                positions.erase(position);
+                number.clear(position);
+            } else {
+                positions.insert(position);
+                number.set(position);
+            }
+            if (i % 20 == 0) {
+                // Copy `a` into `b`, or build `b` again from its positions.
+                if (rng() % 2) {
+                    b = a;
+                    y = x;
+                } else {
+                    y = BitNumber(vector<unsigned int>(b.begin(), b.end()));
+                }
+            }
+            expect((x == y) == (a == b) && (a != b || x.hashValue() == y.hashValue()), "BitNumber equality and hash");
+        }
+        BitNumber moved = std::move(x);
+        expect(moved == BitNumber(vector<unsigned int>(a.begin(), a.end())) && (a.empty() || !(moved == BitNumber())), "BitNumber moved");
+    }
+
+    // Sets differing only in a middle segment hash apart.
+    unordered_set<size_t> hashes;
+    for (unsigned int position = 64; position < 576; position++) {
+        hashes.insert(BitNumber(vector<unsigned int>{0, position, 600}).hashValue());
+    }
+    expect(hashes.size() == 512, "BitNumber hash of middle segments");
+}
+
+void testSubsetArena(std::mt19937& rng)
+{
+    SubsetArena arena;
+    std::map<ArenaVector<FAState>, FAState> ids;
+    for (int i = 0; i < 20000; i++) {
+        std::set<FAState> positions;
+        for (size_t n = rng() % 6; n > 0; n--) {
+            positions.insert(rng() % 40);
+        }
+        const ArenaVector<FAState> states(positions.begin(), positions.end());
+        const auto [id, inserted] = arena.intern(states);
+        const auto found = ids.find(states);
+        expect(inserted == (found == ids.end()) && id == (inserted ? ids.size() : found->second), "SubsetArena::intern");
+        ids.emplace(states, id);
+    }
+    expect(arena.size() == ids.size(), "SubsetArena::size");
+    for (const auto& [states, id] : ids) {
+        expect(ArenaVector<FAState>(arena.begin(id), arena.end(id)) == states, "SubsetArena members");
+    }
+}
+
+void testConstructionArena(std::mt19937& rng)
+{
+    const vector<string> atoms = {"a", "b", "ab", "[^a]", "x{2,5}", "[^\\n]*"};
+    for (int t = 0; t < 100; t++) {
+        const string pattern = randomPattern(rng, atoms, 4);
+        DenseDFA heap{DFA{NFA{pattern}}};
+        std::optional<NFA> kept;
+        std::optional<DenseDFA> dense;
+        {
+            ConstructionArena arena;
+            expect(ConstructionArena::current() == &arena, "ConstructionArena::current");
+            NFA n(pattern);
+            {
+                ConstructionArena inner;
+                dense.emplace(DFA(n));
+            }
+            expect(ConstructionArena::current() == &arena, "ConstructionArena::current after an inner arena");
+            kept.emplace(n); // A copy allocates from the heap, so it outlives the arena.
+        }
+        expect(ConstructionArena::current() == nullptr, "ConstructionArena::current after the arena");
+        DFA fromKept(*kept);
+        for (int i = 0; i < 20; i++) {
+            const string text = randomText(rng, "abx\n", 30);
+            const vector<Substring> found = heap.findRecognizedSubstrings(text);
+            expect(dense->recognize(text) == heap.recognize(text) && dense->findRecognizedSubstrings(text) == found && fromKept.findRecognizedSubstrings(text) == found, "Construction on an arena of " + escaped(pattern) + " on " + escaped(text));
+        }
+    }
+}
+
+void testSaveAndLoad(std::mt19937& rng)
+{
+    const string path = temporaryPath("saved.dfa");
+    const vector<string> atoms = {"a", "b", "c", "[^a]", "hello", "[^\\n]*", "x{2,30}"};
+    for (int t = 0; t < 100; t++) {
+        const string pattern = t == 0 ? "(ab|cd|ef|gh|ij|kl)*[^x]{20}y" : randomPattern(rng, atoms, 4);
+        DenseDFA dense{DFA{NFA{pattern}}};
+        dense.save(path);
+        const DenseDFA loaded = DenseDFA::load(path, t % 2 ? DenseDFA::Verify : DenseDFA::Trusted);
+        for (int i = 0; i < 20; i++) {
+            const string text = randomText(rng, "abcx\nhelo0123.", 200);
+            expect(loaded.recognize(text.data(), text.size()) == dense.recognize(text) && loaded.findRecognizedSubstrings(text.data(), text.size()) == dense.findRecognizedSubstrings(text), "DenseDFA::load(" + escaped(pattern) + ")");
+        }
+    }
+    DenseDFA empty;
+    empty.save(path);
+    expect(!DenseDFA::load(path).recognize("", 0), "DenseDFA::load of a default automaton");
+
+    // Damaged files are rejected.
+    DenseDFA{DFA{NFA{"abc"}}}.save(path);
+    std::ifstream in(path, std::ios::binary);
+    const string saved((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    auto rejects = [&](const string& bytes, const string& what, const DenseDFA::LoadCheck check = DenseDFA::Trusted) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+        bool rejected = false;
+        try {
+            DenseDFA::load(path, check);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        expect(rejected, "DenseDFA::load of " + what);
+    };
+    for (size_t size : {(size_t)0, (size_t)10, (size_t)600, saved.size() - 1}) {
+        rejects(saved.substr(0, size), "a file cut at " + std::to_string(size));
+    }
+    string version = saved;
+    version[8] = 2;
+    rejects(version, "another version");
+    size_t tableOffset = 0;
+    for (size_t i = 0; i < 8; i++) {
+        tableOffset |= (size_t)(unsigned char)saved[48 + i] << (8 * i);
+    }
+    string transition = saved;
+    transition[tableOffset] = (char)0xff;
+    rejects(transition, "a transition out of the table", DenseDFA::Verify);
+    // Without verifying, the table is not read while loading.
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(transition.data(), transition.size());
+    const DenseDFA trusted = DenseDFA::load(path);
+    expect(trusted.recognize("abc", 3) && !trusted.recognize("ab", 2) && !trusted.isAcceptState(0), "DenseDFA::load without verifying");
+    std::filesystem::remove(path);
+}
+
+void testThreadPool(void)
+{
+    ThreadPool pool(3);
+    vector<std::atomic<int>> runs(1000);
+    pool.run(runs.size(), [&](size_t i) { runs[i]++; });
+    expect(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int>& count) { return count == 1; }), "ThreadPool::run runs every task once");
+
+    bool thrown = false;
+    try {
+        pool.run(10, [](size_t i) { if (i == 7) { throw std::runtime_error("task"); } });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    expect(thrown, "ThreadPool::run throws the exception of a task");
+    pool.run(runs.size(), [&](size_t i) { runs[i]++; });
+    expect(runs[999] == 2, "ThreadPool::run after an exception");
+}
+
+void testPatternCache(void)
+{
+    PatternCache cache;
+    const auto first = cache.get("(a|b)*abb");
+    expect(cache.get("(a|b)*abb") == first && cache.get("(a|b)*abb", CaseInsensitive) != first, "PatternCache keys on the pattern and the flags");
+    expect(first->recognize("babb", 4) && !cache.get("(a|b)*abb", CaseInsensitive)->recognize("bab", 3) && cache.get("(a|b)*abb", CaseInsensitive)->recognize("BaBB", 4), "PatternCache automata");
+    PatternCache::Statistics statistics = cache.statistics();
+    expect(statistics.hits == 3 && statistics.misses == 2 && statistics.entries == 2 && statistics.evictions == 0, "PatternCache statistics");
+
+    // Room for about one automaton: the least recently used one goes first.
+    cache.setMemoryLimit(first->memoryUsage() * 3 / 2);
+    statistics = cache.statistics();
+    expect(statistics.entries == 1 && statistics.evictions == 1 && statistics.memoryUsage <= first->memoryUsage() * 3 / 2, "PatternCache evicts down to the limit");
+    expect(first->recognize("abb", 3), "PatternCache automata stay valid after being evicted");
+    cache.get("(a|b)*abb");
+    expect(cache.statistics().misses == 3, "PatternCache compiles an evicted pattern again");
+
+    bool thrown = false;
+    try {
+        cache.get("a(");
+    } catch (const RegexSyntaxError&) {
+        thrown = true;
+    }
+    expect(thrown, "PatternCache throws RegexSyntaxError");
+
+    cache.clear();
+    expect(cache.statistics().entries == 0 && cache.statistics().memoryUsage == 0, "PatternCache::clear");
+}
+
+// Matches of `dfa` found by trying every substring, longest first at every position.
+vector<Substring> leftmostLongest(const DenseDFA& dfa, const string& text)
+{
+    vector<Substring> result;
+    bool emptyMatch = dfa.recognize("", 0);
+    for (size_t position = 0; position < text.size(); ) {
+        size_t longest = 0;
+        for (size_t length = text.size() - position; length > 0 && longest == 0; length--) {
+            if (dfa.recognize(text.data() + position, length)) {
+                longest = length;
+            }
+        }
+        if (longest > 0) {
+            result.push_back({(unsigned int)position, (unsigned int)longest});
+            position += longest;
+        } else {
+            if (emptyMatch) {
+                result.push_back({0, 0});
+            }
+            position++;
+        }
+        emptyMatch = false;
+    }
+    if (emptyMatch) {
+        result.push_back({0, 0});
+    }
+    return result;
+}
+
+void testLeftmostLongest(std::mt19937& rng)
+{
+    const vector<string> atoms = {"a", "b", "c", "[ab]", "ab", "c?"};
+    for (int t = 0; t < 300; t++) {
+        const string pattern = randomPattern(rng, atoms, 4);
+        DenseDFA dense{DFA{NFA{pattern}}};
+        LeftmostLongestMatcher matcher(dense);
+        for (int i = 0; i < 20; i++) {
+            const string text = randomText(rng, "abcx", 40);
+            expect(matcher.findRecognizedSubstrings(text) == leftmostLongest(dense, text), "LeftmostLongestMatcher(" + escaped(pattern) + ", " + escaped(text) + ")");
+        }
+    }
+
+    // Matches across the blocks of reverse states.
+    DenseDFA dense{DFA{NFA{"a+b|a"}}};
+    LeftmostLongestMatcher matcher(dense);
+    const string text = string(10000, 'a') + "b" + string(5000, 'a');
+    vector<Substring> expected = {{0, 10001}};
+    for (unsigned int position = 10001; position < text.size(); position++) {
+        expected.push_back({position, 1});
+    }
+    expect(matcher.findRecognizedSubstrings(text) == expected, "LeftmostLongestMatcher across blocks");
+}
+
+void testStaticRegex(std::mt19937& rng)
+{
+    auto check = [&]<FixedString Pattern, unsigned int Flags = NoFlags>(const string& alphabet) {
+        DenseDFA dense{DFA{NFA{string(Pattern.chars), Flags}}};
+        for (int i = 0; i < 500; i++) {
+            const string text = randomText(rng, alphabet, 12);
+            expect(StaticRegex<Pattern, Flags>::recognize(text) == dense.recognize(text) && StaticRegex<Pattern, Flags>::findRecognizedSubstrings(text) == dense.findRecognizedSubstrings(text), "StaticRegex<" + escaped(Pattern.chars) + ">(" + escaped(text) + ")");
+        }
+    };
+    check.template operator()<"a(b|c)*">("abcx");
+    check.template operator()<"(a{1,2}b){2}">("ab");
+    check.template operator()<"(a(b(c)*)*)*d">("abcd");
+    check.template operator()<"[^b]+", CaseInsensitive>("aAbB");
+    check.template operator()<"a.c">("ab\nc");
+}
+
+void testRegressions(void)
+{
+    // Scans once looped forever when the first byte after a restart led to a terminal state.
+    vector<Substring> expected = {{1, 2}, {5, 2}};
+    expect(DFA(NFA("ab")).findRecognizedSubstrings("xaby ab") == expected, "DFA::findRecognizedSubstrings restarting on a dead byte");
+    expect(DenseDFA(DFA(NFA("ab"))).findRecognizedSubstrings(std::string_view("xaby ab")) == expected, "DenseDFA::findRecognizedSubstrings restarting on a dead byte");
+    expect(DenseDFA(DFA(NFA("ab"))).findRecognizedSubstrings("xaby ab") == expected, "DenseDFA::findRecognizedSubstrings restarting on a dead byte");
+
+    // `makeStar` once looped back to the old start state, so (a*b)* accepted "a".
+    NFA star('a');
+    star.makeStar();
+    star.makeConcatenation(NFA('b'));
+    star.makeStar();
+    expect(!star.recognize("a") && star.recognize("aabb"), "NFA::makeStar of a starred NFA");
+    // `makeUnion` once used 0 as the start state of its left NFA.
+    NFA pairs('.');
+    pairs.makeConcatenation(NFA('.'));
+    pairs.makeStar();
+    NFA ac('a');
+    ac.makeConcatenation(NFA('c'));
+    ac.makeStar();
+    pairs.makeConcatenation(ac);
+    NFA ca('c');
+    ca.makeConcatenation(NFA('a'));
+    pairs.makeUnion(ca);
+    expect(!pairs.recognize("acabb") && pairs.recognize("acab") && pairs.recognize("ca"), "NFA::makeUnion of an NFA not starting at 0");
+}
+
+}
+
+int main(int argc, const char * argv[])
+{
+    const unsigned int seed = argc > 1 ? (unsigned int)std::stoul(argv[1]) : 1;
+    std::mt19937 rng(seed);
+
+    testParser(rng);
+    testEngines(rng);
+    testPrefilter(rng);
+    testAcceleration(rng);
+    testRegexSet(rng);
+    testComposition(rng);
+    testByteClasses();
+    testMinimizer(rng);
+    testSparseSet(rng);
+    testBitNumber(rng);
+    testSubsetArena(rng);
+    testConstructionArena(rng);
+    testSaveAndLoad(rng);
+    testThreadPool();
+    testPatternCache();
+    testLeftmostLongest(rng);
+    testStaticRegex(rng);
+    testRegressions();
+
+    if (failures > 0) {
+        std::cout << failures << " failed with seed " << seed << std::endl;
+        return 1;
+    }
+    std::cout << "passed with seed " << seed << std::endl;
+    return 0;
+}